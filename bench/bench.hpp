@@ -0,0 +1,89 @@
+#pragma once
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Helpers shared by the benchmarks.  These are deliberately small; the
+// benchmarks are meant to show relative performance of alternative code paths
+// on a realistic input, not to be a statistics package.
+
+namespace bench {
+
+// A repeatable, realistic looking score: mostly notes, with beams, chords,
+// tuplets, and the occasional meter, clef, or key change mixed in.
+inline std::string score(std::size_t columns)
+{
+    static const std::vector<std::string> pitches{
+        "c", "d", "ef", "f", "g", "af", "bf", "cs'", "e'", "fs,"
+    };
+    static const std::vector<std::string> values{ "4", "8", "2", "16", "4." };
+
+    std::string lily = "{ ";
+    std::uint32_t seed = 12345;
+    auto next = [&seed](std::uint32_t n) {
+        seed = seed * 1103515245u + 12345u;
+        return (seed >> 16) % n;
+    };
+
+    for (std::size_t i = 0; i < columns; ++i) {
+        const auto &p = pitches[next(pitches.size())];
+        const auto &q = pitches[next(pitches.size())];
+        switch (next(16)) {
+        case 0:
+            lily += fmt::format("[{}8 {}8 {}16 {}16] ", p, q, p, q);
+            break;
+        case 1:
+            lily += fmt::format("<{} {}>{} ", p, p == q ? "b" : q, values[next(values.size())]);
+            break;
+        case 2:
+            lily += fmt::format(R"(\tuplet 3/2 {{{}8 {}8 {}8}} )", p, q, p);
+            break;
+        case 3:
+            lily += "r4 ";
+            break;
+        case 4:
+            lily += next(8) == 0 ? R"(\time 3/4 )" : R"(\key g \major )";
+            break;
+        default:
+            lily += fmt::format("{}{} ", p, values[next(values.size())]);
+            break;
+        }
+    }
+    lily += "}\n";
+    return lily;
+}
+
+// Best of several runs, in seconds.
+template <typename Function>
+double seconds(Function &&f, int runs = 5)
+{
+    double best = 1e300;
+    for (int i = 0; i < runs; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+// The p-th percentile, 0 <= p <= 100, of some samples.
+inline double percentile(std::vector<double> samples, double p)
+{
+    auto n = static_cast<std::size_t>(p / 100 * (samples.size() - 1) + 0.5);
+    std::nth_element(samples.begin(), samples.begin() + n, samples.end());
+    return samples[n];
+}
+
+inline void report(const std::string &name, std::size_t bytes, double seconds)
+{
+    fmt::print("{:<32} {:>10.1f} MB/s {:>10.3f} s\n",
+               name, static_cast<double>(bytes) / seconds / 1e6, seconds);
+}
+
+} // namespace bench
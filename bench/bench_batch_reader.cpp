@@ -0,0 +1,44 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include <stan/thread_pool.hpp>
+#include "bench.hpp"
+
+// Throughput of batch_reader in snippets per second, at increasing thread
+// counts, against parsing the same snippets one at a time with a fresh reader
+// for each.
+
+int main(int argc, char **argv)
+{
+    std::size_t count = argc > 1 ? std::stoul(argv[1]) : 200000;
+
+    stan::lilypond::writer write;
+    std::string score = bench::score(count);
+    std::vector<std::string> snippets;
+    for (auto &c : stan::lilypond::sequence_reader(std::string_view(score))) {
+        snippets.push_back(write(c));
+    }
+    std::vector<std::string_view> views(snippets.begin(), snippets.end());
+    fmt::print("{} snippets\n", snippets.size());
+
+    auto report = [&snippets](const std::string &name, double seconds) {
+        fmt::print("{:<32} {:>12.0f} snippets/s {:>10.3f} s\n", name,
+                   static_cast<double>(snippets.size()) / seconds, seconds);
+    };
+
+    double sequential = bench::seconds([&] {
+        for (const auto &s : snippets) {
+            stan::lilypond::reader().parse(s);
+        }
+    }, 3);
+    report("one reader per snippet", sequential);
+
+    for (std::size_t threads : { 1, 2, 4, 8, 16 }) {
+        stan::thread_pool pool(threads);
+        stan::lilypond::batch_reader read(pool);
+        double batch = bench::seconds([&] {
+            read(views);
+            read.release();
+        }, 3);
+        report(fmt::format("batch, {} threads ({:.1f}x)", threads, sequential / batch), batch);
+    }
+}
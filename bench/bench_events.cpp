@@ -0,0 +1,73 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include "bench.hpp"
+
+// A read-filter-write pipeline that moves every note up an octave, through a
+// tree of columns and through events.
+
+struct octave_up : stan::lilypond::event_filter
+{
+    using event_filter::event_filter;
+
+    void on_note(const stan::note &n) override
+    {
+        stan::note up = n;
+        up.m_pitch.m_octave = stan::octave(
+            std::min(static_cast<std::uint8_t>(n.m_pitch.m_octave) + 1, 7));
+        m_next.on_note(up);
+    }
+};
+
+struct tree_octave_up
+{
+    void operator()(stan::note &n) const
+    {
+        n.m_pitch.m_octave = stan::octave(
+            std::min(static_cast<std::uint8_t>(n.m_pitch.m_octave) + 1, 7));
+    }
+
+    void operator()(stan::beam &b) const { elements(b.m_elements); }
+    void operator()(stan::tuplet &t) const { elements(t.m_elements); }
+
+    template <typename T>
+    void operator()(T &) const {}
+
+    void elements(std::pmr::vector<stan::column> &e) const
+    {
+        for (auto &c : e) {
+            std::visit(*this, c);
+        }
+    }
+};
+
+int main(int argc, char **argv)
+{
+    std::size_t columns = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+    std::string lily = bench::score(columns);
+    std::string_view body = std::string_view(lily).substr(2, lily.size() - 4);
+    fmt::print("{} columns, {} bytes\n", columns, body.size());
+
+    stan::lilypond::writer write;
+    double tree = bench::seconds([&] {
+        std::vector<stan::column> music;
+        stan::lilypond::reader().append(body, music);
+        std::string out;
+        for (auto &c : music) {
+            std::visit(tree_octave_up(), c);
+            out += write(c);
+            out += ' ';
+        }
+    }, 3);
+    bench::report("tree", body.size(), tree);
+
+    stan::lilypond::event_reader read;
+    std::string out;
+    double events = bench::seconds([&] {
+        out.clear();
+        stan::lilypond::event_writer writer(out);
+        octave_up filter(writer);
+        read(body, filter);
+    }, 3);
+    bench::report(fmt::format("events ({:.1f}x)", tree / events), body.size(), events);
+}
@@ -0,0 +1,64 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include <stan/thread_pool.hpp>
+#include "bench.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+// A score of 40 parts, one file each, joined with \include.  Reading it from
+// scratch, again with nothing changed, and again after editing one part, with
+// parsing the one part on its own for comparison.
+
+int main(int argc, char **argv)
+{
+    namespace fs = std::filesystem;
+
+    std::size_t columns = argc > 1 ? std::stoul(argv[1]) : 20000;
+    constexpr std::size_t parts = 40;
+
+    fs::path directory = fs::temp_directory_path() / "bench.include_reader";
+    fs::create_directories(directory);
+
+    std::string body = bench::score(columns);
+    body = body.substr(2, body.size() - 4);
+
+    std::string root = "{\n";
+    for (std::size_t i = 0; i < parts; ++i) {
+        std::string name = fmt::format("part{}.ly", i);
+        std::ofstream(directory / name) << body << '\n';
+        root += fmt::format("\\include \"{}\"\n", name);
+    }
+    root += "}\n";
+    std::ofstream(directory / "score.ly") << root;
+    std::string score = (directory / "score.ly").string();
+    fmt::print("{} parts of {} columns, {} bytes each\n", parts, columns, body.size());
+
+    stan::thread_pool pool;
+    double one = bench::seconds([&] {
+        std::vector<stan::column> music;
+        stan::lilypond::reader().append(body, music);
+    }, 3);
+    bench::report("one part", body.size(), one);
+
+    double cold = bench::seconds([&] {
+        stan::lilypond::include_reader read(pool);
+        read(score);
+    }, 1);
+    bench::report(fmt::format("whole score, {} threads", pool.size()), body.size() * parts, cold);
+
+    stan::lilypond::include_reader read(pool);
+    read(score);
+    double unchanged = bench::seconds([&] { read(score); });
+    bench::report("unchanged", body.size() * parts, unchanged);
+
+    int edit = 0;
+    double edited = bench::seconds([&] {
+        std::ofstream(directory / "part7.ly") << body << fmt::format(" c{}\n", 1 << (++edit % 4));
+        read(score);
+    }, 3);
+    bench::report(fmt::format("one part edited ({:.2f}x one part)", edited / one),
+                  body.size() * parts, edited);
+
+    fs::remove_all(directory);
+}
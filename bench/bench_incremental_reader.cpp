@@ -0,0 +1,44 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include "bench.hpp"
+
+// Latency of one keystroke in the middle of documents of increasing size:
+// incremental_reader against parsing the whole document again.  A "[" typed
+// and then deleted leaves the brackets unbalanced in between, which must not
+// cost a parse of the rest of the document.
+
+int main()
+{
+    constexpr int keystrokes = 1000;
+
+    for (std::size_t columns : { 1000, 10000, 100000 }) {
+        std::string score = bench::score(columns);
+        std::string lily = score.substr(2, score.size() - 4);
+        std::size_t middle = lily.find(' ', lily.size() / 2) + 1;
+
+        stan::lilypond::incremental_reader incremental(lily);
+        double edit = bench::seconds([&] {
+            for (int i = 0; i < keystrokes; ++i) {
+                incremental.edit(middle, 0, "c4 ");
+                incremental.edit(middle, 3, "");
+            }
+        });
+        double unbalanced = bench::seconds([&] {
+            for (int i = 0; i < keystrokes; ++i) {
+                incremental.edit(middle, 0, "[");
+                incremental.edit(middle, 1, "");
+            }
+        });
+
+        stan::lilypond::reader read;
+        double full = bench::seconds([&] {
+            std::vector<stan::column> music;
+            read.recover(lily, music);
+        });
+
+        fmt::print("{:>7} columns: {:>10.1f} us per keystroke, {:>10.1f} us unbalanced, "
+                   "{:>10.1f} us full parse\n",
+                   columns, edit / (2 * keystrokes) * 1e6, unbalanced / (2 * keystrokes) * 1e6,
+                   full * 1e6);
+    }
+}
@@ -0,0 +1,51 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include <stan/driver/lilypond/literals.hpp>
+#include "bench.hpp"
+
+#include <cstring>
+
+// Fixed snippets, read by the reader at startup, against the same snippets as
+// literals, which the compiler has already parsed.  What is left for the
+// literals is copying the columns into vectors.
+
+using namespace stan::lilypond::literals;
+
+#define SNIPPETS(X)                                             \
+    X("c'4 d'4 e'4 f'4 g'2 g'2")                                \
+    X("\\key g \\major g4 a4 b4 c'4 d'2 r2")                    \
+    X("\\clef bass c,4. d,8 e,4 f,4 g,1")                       \
+    X("\\key d \\minor d'8 e'8 f'8 g'8 a'4 bf'4 a'2 r4 cs'4")   \
+    X("r8 ef''16 d''16 c''8 bf'8 af'4 g'4 f'2..")               \
+    X("\\clef alto c4 e4 g4 c'4 \\clef treble e''1")
+
+#define TEXT(s) s,
+#define LITERAL(s) s##_ly.columns(),
+
+int main(int argc, char **argv)
+{
+    int repeat = argc > 1 ? std::stoi(argv[1]) : 100;
+
+    static const char *texts[] = { SNIPPETS(TEXT) };
+    std::size_t bytes = 0;
+    for (const char *t : texts) {
+        bytes += std::strlen(t);
+    }
+    bytes *= repeat;
+    fmt::print("{} snippets, {} times\n", std::size(texts), repeat);
+
+    stan::lilypond::reader read;
+    bench::report("reader", bytes, bench::seconds([&] {
+                      for (int r = 0; r < repeat; ++r) {
+                          for (const char *t : texts) {
+                              std::vector<stan::column> music;
+                              read.append(t, music);
+                          }
+                      }
+                  }));
+    bench::report("literals", bytes, bench::seconds([&] {
+                      for (int r = 0; r < repeat; ++r) {
+                          std::vector<std::vector<stan::column>> music{ SNIPPETS(LITERAL) };
+                      }
+                  }));
+}
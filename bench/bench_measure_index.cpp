@@ -0,0 +1,53 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include "bench.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+// Getting at a page of measures from the middle of a big file: parsing from
+// the start up to the end of the page, against seeking with the measure index,
+// and the one time cost of building the index and loading it again.
+
+int main(int argc, char **argv)
+{
+    namespace fs = std::filesystem;
+
+    std::size_t columns = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    constexpr std::size_t page = 16;
+
+    std::string path = (fs::temp_directory_path() / "bench.measure_index.ly").string();
+    std::string lily = bench::score(columns);
+    std::ofstream(path) << lily;
+    fmt::print("{} columns, {} bytes\n", columns, lily.size());
+
+    stan::lilypond::measure_index index = stan::lilypond::measure_index::build(path);
+    std::size_t first = index.size() / 2;
+    fmt::print("{} measures, reading [{}, {})\n", index.size(), first, first + page);
+
+    std::uint64_t end = index[first + page].m_offset;
+    double scratch = bench::seconds([&] {
+        std::vector<stan::column> music;
+        stan::lilypond::reader().append(std::string_view(lily).substr(2, end - 2), music);
+    }, 3);
+    bench::report("parse up to the page", end, scratch);
+
+    double build = bench::seconds([&] { stan::lilypond::measure_index::build(path); }, 3);
+    bench::report("build the index", lily.size(), build);
+
+    index.save(path + ".idx");
+    double load = bench::seconds([&] {
+        stan::lilypond::measure_index::load(path + ".idx");
+    });
+    fmt::print("{:<32} {:>10} bytes {:>10.6f} s\n", "load the index",
+               fs::file_size(path + ".idx"), load);
+
+    stan::lilypond::reader read;
+    double seek = bench::seconds([&] { index.measures(lily, first, first + page, read); });
+    fmt::print("{:<32} {:>15.6f} s ({:.0f}x)\n", "seek and parse the page", seek,
+               scratch / seek);
+
+    std::remove((path + ".idx").c_str());
+    std::remove(path.c_str());
+}
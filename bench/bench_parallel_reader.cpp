@@ -0,0 +1,31 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include <stan/thread_pool.hpp>
+#include "bench.hpp"
+
+// Speedup of parallel_reader over collecting a sequence_reader into a vector,
+// at increasing thread counts.
+
+int main(int argc, char **argv)
+{
+    std::size_t columns = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+    std::string lily = bench::score(columns);
+    fmt::print("{} columns, {} bytes\n", columns, lily.size());
+
+    double sequential = bench::seconds([&] {
+        std::vector<stan::column> music;
+        for (auto &c : stan::lilypond::sequence_reader(std::string_view(lily))) {
+            music.push_back(std::move(c));
+        }
+    }, 3);
+    bench::report("sequential", lily.size(), sequential);
+
+    for (std::size_t threads : { 1, 2, 4, 8, 16 }) {
+        stan::thread_pool pool(threads);
+        stan::lilypond::parallel_reader read(pool);
+        double parallel = bench::seconds([&] { read(lily); }, 3);
+        bench::report(fmt::format("parallel, {} threads ({:.1f}x)", threads, sequential / parallel),
+                      lily.size(), parallel);
+    }
+}
@@ -0,0 +1,56 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include <stan/thread_pool.hpp>
+#include "bench.hpp"
+
+#include <cstdio>
+#include <unistd.h>
+
+// Speedup of parallel_writer over sequence_writer, at increasing thread
+// counts, into a string and into a temporary file with pwrite().
+
+int main(int argc, char **argv)
+{
+    std::size_t columns = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+    std::string lily = bench::score(columns);
+    std::vector<stan::column> music;
+    for (auto &c : stan::lilypond::sequence_reader(std::string_view(lily))) {
+        music.push_back(std::move(c));
+    }
+    fmt::print("{} columns, {} bytes\n", columns, lily.size());
+
+    std::FILE *file = std::tmpfile();
+    int fd = fileno(file);
+    auto rewind = [fd] {
+        if (::ftruncate(fd, 0) != 0 or ::lseek(fd, 0, SEEK_SET) != 0) {
+            std::perror("tmpfile");
+            std::exit(1);
+        }
+    };
+
+    double sequential = bench::seconds([&] {
+        rewind();
+        stan::lilypond::sequence_writer out(fd);
+        for (const auto &c : music) {
+            out(c);
+        }
+        out.finish();
+    }, 3);
+    bench::report("sequential", lily.size(), sequential);
+
+    for (std::size_t threads : { 1, 2, 4, 8, 16 }) {
+        stan::thread_pool pool(threads);
+        stan::lilypond::parallel_writer write(pool);
+        double string = bench::seconds([&] { write(music); }, 3);
+        double pwrite = bench::seconds([&] {
+            rewind();
+            write(music, fd);
+        }, 3);
+        bench::report(fmt::format("string, {} threads ({:.1f}x)", threads, sequential / string),
+                      lily.size(), string);
+        bench::report(fmt::format("pwrite, {} threads ({:.1f}x)", threads, sequential / pwrite),
+                      lily.size(), pwrite);
+    }
+    std::fclose(file);
+}
@@ -0,0 +1,35 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include "bench.hpp"
+
+// Throughput of push_reader fed in pieces of various sizes, against
+// sequence_reader over the whole text at once.
+
+int main(int argc, char **argv)
+{
+    std::size_t columns = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+    std::string lily = bench::score(columns);
+    std::string_view view = lily;
+    fmt::print("{} columns, {} bytes\n", columns, lily.size());
+
+    double whole = bench::seconds([&] {
+        std::size_t count = 0;
+        for (auto &c : stan::lilypond::sequence_reader(view)) {
+            count += c.index();
+        }
+    }, 3);
+    bench::report("sequence_reader", lily.size(), whole);
+
+    for (std::size_t piece : { 16, 256, 4096, 65536 }) {
+        double push = bench::seconds([&] {
+            std::size_t count = 0;
+            stan::lilypond::push_reader read([&count](stan::column &&c) { count += c.index(); });
+            for (std::size_t i = 0; i < view.size(); i += piece) {
+                read.feed(view.substr(i, piece));
+            }
+            read.finish();
+        }, 3);
+        bench::report(fmt::format("push_reader, {} byte pieces", piece), lily.size(), push);
+    }
+}
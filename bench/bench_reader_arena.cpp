@@ -0,0 +1,77 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include "bench.hpp"
+
+// Latency of parsing and then freeing the result, with the nodes allocated
+// from the heap and from a reader's arena, for small snippets and for large
+// files.
+
+// Time each call of f, which parses one input and frees the result.
+template <typename Function>
+std::vector<double> latencies(std::size_t count, Function &&f)
+{
+    std::vector<double> samples;
+    for (std::size_t i = 0; i < count; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        f(i);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        samples.push_back(elapsed.count());
+    }
+    return samples;
+}
+
+void report(const std::string &name, const std::vector<double> &samples)
+{
+    fmt::print("{:<24} p50 {:>10.2f} us   p99 {:>10.2f} us   max {:>10.2f} us\n", name,
+               bench::percentile(samples, 50) * 1e6, bench::percentile(samples, 99) * 1e6,
+               bench::percentile(samples, 100) * 1e6);
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t count = argc > 1 ? std::stoul(argv[1]) : 200000;
+
+    stan::lilypond::writer write;
+    std::string score = bench::score(count);
+    std::vector<std::string> snippets;
+    for (auto &c : stan::lilypond::sequence_reader(std::string_view(score))) {
+        // Beams and tuplets, which are the snippets that allocate.
+        if (std::holds_alternative<stan::beam>(c) or std::holds_alternative<stan::tuplet>(c)) {
+            snippets.push_back(write(c));
+        }
+    }
+    std::string_view body = std::string_view(score).substr(2, score.size() - 4);
+    fmt::print("{} snippets, one file of {} columns, {} bytes\n", snippets.size(), count,
+               score.size());
+
+    stan::lilypond::reader heap;
+    stan::lilypond::reader arena(stan::lilypond::arena);
+
+    for (int warmup = 0; warmup < 2; ++warmup) {
+        for (const auto &s : snippets) {
+            heap(s);
+            arena(s);
+            arena.release();
+        }
+    }
+
+    report("snippets, heap", latencies(snippets.size(), [&](std::size_t i) {
+               heap(snippets[i]);
+           }));
+    report("snippets, arena", latencies(snippets.size(), [&](std::size_t i) {
+               arena(snippets[i]);
+               arena.release();
+           }));
+
+    constexpr std::size_t files = 50;
+    report("file, heap", latencies(files, [&](std::size_t) {
+               std::vector<stan::column> music;
+               heap.append(body, music);
+           }));
+    report("file, arena", latencies(files, [&](std::size_t) {
+               std::vector<stan::column> music;
+               arena.append(body, music);
+               music.clear();
+               arena.release();
+           }));
+}
@@ -0,0 +1,35 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include "bench.hpp"
+
+// Throughput of the Spirit X3 reader against the hand written predictive
+// reader, parsing every column of a generated score one at a time.
+
+template <typename Reader>
+void run(const std::string &name, const std::vector<std::string> &columns, std::size_t bytes)
+{
+    Reader read;
+    bench::report(name, bytes, bench::seconds([&] {
+                      for (const auto &c : columns) {
+                          read(c);
+                      }
+                  }));
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t count = argc > 1 ? std::stoul(argv[1]) : 200000;
+
+    stan::lilypond::writer write;
+    std::string score = bench::score(count);
+    std::vector<std::string> columns;
+    std::size_t bytes = 0;
+    for (auto &c : stan::lilypond::sequence_reader(std::string_view(score))) {
+        columns.push_back(write(c));
+        bytes += columns.back().size();
+    }
+    fmt::print("{} columns, {} bytes\n", columns.size(), bytes);
+
+    run<stan::lilypond::reader>("x3 reader", columns, bytes);
+    run<stan::lilypond::predictive_reader>("predictive reader", columns, bytes);
+}
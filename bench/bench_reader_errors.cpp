@@ -0,0 +1,44 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include "bench.hpp"
+
+// Rejecting malformed snippets through exceptions, against the non-throwing
+// reader::parse.  Every column of a generated score is cut short by one
+// byte, which leaves most of them malformed.
+
+int main(int argc, char **argv)
+{
+    std::size_t count = argc > 1 ? std::stoul(argv[1]) : 200000;
+
+    stan::lilypond::writer write;
+    std::string score = bench::score(count);
+    std::vector<std::string> snippets;
+    std::size_t bytes = 0;
+    for (auto &c : stan::lilypond::sequence_reader(std::string_view(score))) {
+        std::string lily = write(c);
+        lily.pop_back();
+        bytes += lily.size();
+        snippets.push_back(std::move(lily));
+    }
+
+    stan::lilypond::reader read;
+    std::size_t errors = 0;
+    for (const auto &s : snippets) {
+        errors += !read.parse(s).has_value();
+    }
+    fmt::print("{} snippets, {} bytes, {} malformed\n", snippets.size(), bytes, errors);
+
+    bench::report("exceptions", bytes, bench::seconds([&] {
+                      for (const auto &s : snippets) {
+                          try {
+                              read(s);
+                          } catch (std::exception &) {
+                          }
+                      }
+                  }));
+    bench::report("parse", bytes, bench::seconds([&] {
+                      for (const auto &s : snippets) {
+                          read.parse(s);
+                      }
+                  }));
+}
@@ -0,0 +1,55 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include "bench.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+// Compare the three ways of getting a file into the sequence reader: reading
+// it into a std::string first, parsing a string_view over characters that are
+// already in memory, and parsing a read-only memory mapping of the file.
+
+int main(int argc, char **argv)
+{
+    std::size_t columns = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    std::string path = argc > 2 ? argv[2] : "bench.reader_input.ly";
+
+    std::string lily = bench::score(columns);
+    std::ofstream(path) << lily;
+    fmt::print("{} columns, {} bytes\n", columns, lily.size());
+
+    std::size_t count = 0;
+    auto drain = [&count](stan::lilypond::sequence_reader &&read) {
+        count = 0;
+        for (auto &c : read) {
+            (void)c;
+            ++count;
+        }
+    };
+
+    bench::report("std::string", lily.size(), bench::seconds([&] {
+                      std::ifstream file(path);
+                      std::string text((std::istreambuf_iterator<char>(file)),
+                                       std::istreambuf_iterator<char>());
+                      drain(stan::lilypond::sequence_reader(std::string_view(text)));
+                  }));
+
+    bench::report("std::string_view", lily.size(), bench::seconds([&] {
+                      drain(stan::lilypond::sequence_reader(std::string_view(lily)));
+                  }));
+
+    bench::report("mmap", lily.size(), bench::seconds([&] {
+                      drain(stan::lilypond::sequence_reader(
+                          stan::lilypond::mapped_file(path)));
+                  }));
+
+    bench::report("std::istream", lily.size(), bench::seconds([&] {
+                      std::ifstream file(path);
+                      drain(stan::lilypond::sequence_reader(file));
+                  }));
+
+    std::remove(path.c_str());
+    return count == columns ? 0 : 1;
+}
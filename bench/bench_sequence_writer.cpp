@@ -0,0 +1,78 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include "bench.hpp"
+
+#include <cstdio>
+#include <unistd.h>
+
+// A generated score written to a temporary file: built whole in a string and
+// written at once, as before; streamed column by column; and, for text that
+// is already written, streamed in the pieces that cat would copy, against a
+// single write() of the whole text.
+
+int main(int argc, char **argv)
+{
+    std::size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+    std::string score = bench::score(count);
+    std::vector<stan::column> music;
+    for (auto &c : stan::lilypond::sequence_reader(std::string_view(score))) {
+        music.push_back(std::move(c));
+    }
+    stan::lilypond::writer write;
+
+    // The columns of the score, with the space after each, in the pieces that
+    // cat would read them in.
+    std::string_view body = std::string_view(score).substr(2, score.size() - 4);
+    std::size_t piece = 128 * 1024;
+
+    std::FILE *file = std::tmpfile();
+    int fd = fileno(file);
+    auto rewind = [fd] {
+        if (::ftruncate(fd, 0) != 0 or ::lseek(fd, 0, SEEK_SET) != 0) {
+            std::perror("tmpfile");
+            std::exit(1);
+        }
+    };
+    fmt::print("{} columns, {} bytes\n", music.size(), score.size());
+
+    bench::report("string, then write()", score.size(), bench::seconds([&] {
+                      rewind();
+                      std::string lily = "{ ";
+                      for (const auto &c : music) {
+                          lily += write(c);
+                          lily += ' ';
+                      }
+                      lily += "}\n";
+                      if (::write(fd, lily.data(), lily.size()) < 0) {
+                          std::exit(1);
+                      }
+                  }));
+    bench::report("sequence_writer", score.size(), bench::seconds([&] {
+                      rewind();
+                      stan::lilypond::sequence_writer out(fd);
+                      for (const auto &c : music) {
+                          out(c);
+                      }
+                      out.finish();
+                  }));
+    bench::report("sequence_writer, written", score.size(), bench::seconds([&] {
+                      rewind();
+                      stan::lilypond::sequence_writer out(fd);
+                      for (std::size_t i = 0; i < body.size(); i += piece) {
+                          out.append(body.substr(i, piece));
+                      }
+                      out.finish();
+                  }));
+    bench::report("write() of the text", score.size(), bench::seconds([&] {
+                      rewind();
+                      if (::write(fd, score.data(), score.size()) < 0) {
+                          std::exit(1);
+                      }
+                  }));
+
+    std::size_t buffered = stan::lilypond::sequence_writer::buffer_size *
+        stan::lilypond::sequence_writer::buffer_count;
+    fmt::print("sequence_writer buffers {} bytes, the string {}\n", buffered, score.size());
+    std::fclose(file);
+}
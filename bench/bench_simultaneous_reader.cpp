@@ -0,0 +1,40 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include <stan/thread_pool.hpp>
+#include "bench.hpp"
+
+// An orchestral score of 30 staves in simultaneous music, parsed one staff
+// after another, and with simultaneous_reader at increasing thread counts.
+
+int main(int argc, char **argv)
+{
+    std::size_t columns = argc > 1 ? std::stoul(argv[1]) : 20000;
+    constexpr std::size_t staves = 30;
+
+    std::vector<std::string> bodies;
+    std::string lily = "<<\n";
+    for (std::size_t i = 0; i < staves; ++i) {
+        std::string staff = bench::score(columns + i);
+        bodies.push_back(staff.substr(2, staff.size() - 4));
+        lily += staff;
+    }
+    lily += ">>\n";
+    fmt::print("{} staves of {} columns, {} bytes\n", staves, columns, lily.size());
+
+    double sequential = bench::seconds([&] {
+        stan::lilypond::reader read;
+        stan::lilypond::simultaneous_music music;
+        for (const auto &body : bodies) {
+            read.append(body, music.m_voices.emplace_back());
+        }
+    }, 3);
+    bench::report("one staff after another", lily.size(), sequential);
+
+    for (std::size_t threads : { 1, 2, 4, 8, 16, 30 }) {
+        stan::thread_pool pool(threads);
+        stan::lilypond::simultaneous_reader read(pool);
+        double parallel = bench::seconds([&] { read(lily); }, 3);
+        bench::report(fmt::format("{} threads ({:.1f}x)", threads, sequential / parallel),
+                      lily.size(), parallel);
+    }
+}
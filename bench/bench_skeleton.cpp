@@ -0,0 +1,34 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include "bench.hpp"
+
+// Cost of getting at a few columns from the middle of a big file: parsing the
+// whole file, against building its skeleton and then only the columns needed.
+
+int main(int argc, char **argv)
+{
+    std::size_t columns = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    constexpr std::size_t page = 64;
+
+    std::string lily = bench::score(columns);
+    fmt::print("{} columns, {} bytes\n", columns, lily.size());
+
+    double full = bench::seconds([&] {
+        std::vector<stan::column> music;
+        for (auto &c : stan::lilypond::sequence_reader(std::string_view(lily))) {
+            music.push_back(std::move(c));
+        }
+    }, 3);
+    bench::report("full parse", lily.size(), full);
+
+    double skeleton = bench::seconds([&] { stan::lilypond::skeleton s(lily); });
+    bench::report(fmt::format("skeleton ({:.1f}x)", full / skeleton), lily.size(), skeleton);
+
+    stan::lilypond::reader read;
+    double preview = bench::seconds([&] {
+        stan::lilypond::skeleton s(lily);
+        s.build(s.size() / 2, std::min(s.size(), s.size() / 2 + page), read);
+    });
+    bench::report(fmt::format("skeleton + {} columns ({:.1f}x)", page, full / preview),
+                  lily.size(), preview);
+}
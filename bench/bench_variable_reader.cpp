@@ -0,0 +1,79 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include "bench.hpp"
+
+#include <numeric>
+
+// A score that is mostly repeats of a few themes, read with the themes in
+// variables, against the same score written out in full.  Columns counts the
+// notation objects each one keeps, which is what memory grows with.  Then the
+// same for a \repeat, and the cost of its duration and of unfolding it.
+
+int main(int argc, char **argv)
+{
+    std::size_t references = argc > 1 ? std::stoul(argv[1]) : 2000;
+    constexpr std::size_t themes = 4;
+    constexpr std::size_t theme_columns = 250;
+
+    std::string lily;
+    std::vector<std::string> bodies;
+    for (std::size_t i = 0; i < themes; ++i) {
+        std::string body = bench::score(theme_columns + i);
+        bodies.push_back(body.substr(2, body.size() - 4));
+        lily += fmt::format("theme{} = {}", std::string(1, static_cast<char>('a' + i)), body);
+    }
+
+    std::string score = "{";
+    std::string expanded = "{";
+    for (std::size_t i = 0; i < references; ++i) {
+        char theme = static_cast<char>('a' + i % themes);
+        score += fmt::format(" \\theme{} r4", theme);
+        expanded += fmt::format(" {} r4", bodies[i % themes]);
+    }
+    lily += score + " }\n";
+    expanded += " }\n";
+    fmt::print("{} references to {} themes, {} bytes, {} bytes expanded\n", references,
+               themes, lily.size(), expanded.size());
+
+    std::size_t kept = 0;
+    std::size_t size = 0;
+    double shared = bench::seconds([&] {
+        stan::lilypond::variable_reader read;
+        auto music = read(lily);
+        kept = music->m_columns.size();
+        for (const auto &[name, variable] : read.variables()) {
+            kept += variable->m_columns.size();
+        }
+        size = music->m_size;
+    }, 3);
+    bench::report(fmt::format("variables, {} of {} columns kept", kept, size), lily.size(),
+                  shared);
+
+    double full = bench::seconds([&] {
+        std::vector<stan::column> music;
+        for (auto &c : stan::lilypond::sequence_reader(std::string_view(expanded))) {
+            music.push_back(std::move(c));
+        }
+        size = music.size();
+    }, 3);
+    bench::report(fmt::format("expanded, {} of {} columns kept ({:.1f}x)", size, size,
+                              full / shared),
+                  expanded.size(), full);
+
+    std::string repeated = fmt::format("{{ \\repeat unfold {} {{ {} }} }}", references, bodies[0]);
+    stan::lilypond::variable_reader read;
+    double unfolded = bench::seconds([&] { read(repeated); });
+    auto music = read(repeated);
+    bench::report(fmt::format("repeat, {} of {} columns kept", music->m_columns.size() +
+                                  music->m_parts[0].m_music->m_columns.size(), music->m_size),
+                  repeated.size(), unfolded);
+
+    stan::duration walked = stan::duration::zero();
+    double walk = bench::seconds([&] {
+        walked = std::accumulate(music->begin(), music->end(), stan::duration::zero());
+    }, 3);
+    stan::duration stored = stan::duration::zero();
+    double lookup = bench::seconds([&] { stored = music->m_duration; });
+    fmt::print("duration: unfolded {:.6f} s, stored {:.9f} s, {}\n", walk, lookup,
+               walked == stored ? "equal" : "different");
+}
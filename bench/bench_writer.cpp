@@ -0,0 +1,39 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include "bench.hpp"
+
+// A single beam of more and more notes, written as a string and into a buffer
+// that is reused.  Writing is linear when the time per element stays flat as
+// the beam grows.
+
+int main(int argc, char **argv)
+{
+    std::size_t largest = argc > 1 ? std::stoul(argv[1]) : 256000;
+
+    const stan::note notes[] = {
+        { stan::value::eighth(), { stan::pitchclass::c, stan::octave(4) } },
+        { stan::value::sixteenth(), { stan::pitchclass::fs, stan::octave(3) } },
+        { stan::value::eighth(), { stan::pitchclass::bf, stan::octave(5) } },
+    };
+
+    stan::lilypond::writer write;
+    fmt::memory_buffer buffer;
+    fmt::print("{:>10} {:>16} {:>16}\n", "elements", "string ns/elem", "buffer ns/elem");
+    for (std::size_t size = 1000; size <= largest; size *= 4) {
+        std::vector<stan::column> elements;
+        for (std::size_t i = 0; i < size; ++i) {
+            elements.emplace_back(notes[i % std::size(notes)]);
+        }
+        stan::column wide = stan::beam(elements);
+
+        std::size_t bytes = 0;
+        double string = bench::seconds([&] { bytes += write(wide).size(); });
+        double buffered = bench::seconds([&] {
+            buffer.clear();
+            write.write_to(buffer, wide);
+            bytes += buffer.size();
+        });
+        fmt::print("{:>10} {:>16.1f} {:>16.1f}\n", size, string / size * 1e9,
+                   buffered / size * 1e9);
+    }
+}
@@ -0,0 +1,128 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A fuzz target for stan::lilypond::reader, for libFuzzer, or for AFL++ in
+// its libFuzzer compatible mode.  Every input is read by both backends, which
+// must agree on the column or on the error, and checked by the validator,
+// which must agree on whether it is valid at all.  So wrong parses are found
+// as well as crashes and hangs.
+//
+// Without libFuzzer (STAN_FUZZ off), main() below runs the target on files
+// and directories of inputs instead, or on standard input for plain AFL.
+// That reproduces a finding, and with --slowest n, it reports the n inputs
+// that took the longest per byte, which are the ones to look at for a parse
+// time that grows faster than the input.
+
+namespace {
+
+// Whether the input was read, and what it was read as, or why not.
+template <typename Reader>
+std::pair<bool, std::string> outcome(Reader &read, std::string_view lily)
+{
+    static stan::lilypond::writer write;
+    try {
+        return { true, write(read(lily)) };
+    } catch (const std::exception &e) {
+        return { false, e.what() };
+    }
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size)
+{
+    static stan::lilypond::reader read;
+    static stan::lilypond::predictive_reader predict;
+    static stan::lilypond::validator valid;
+
+    std::string_view lily(reinterpret_cast<const char *>(data), size);
+    auto expected = outcome(read, lily);
+    if (outcome(predict, lily) != expected or valid(lily) != expected.first) {
+        std::abort();
+    }
+    return 0;
+}
+
+#ifndef STAN_FUZZ
+
+namespace fs = std::filesystem;
+
+int main(int argc, char **argv)
+{
+    std::size_t slowest = 0;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--slowest" and i + 1 < argc) {
+            slowest = std::stoul(argv[++i]);
+        } else {
+            paths.push_back(arg);
+        }
+    }
+
+    struct timing
+    {
+        double m_per_byte;
+        std::size_t m_size;
+        std::string m_path;
+    };
+    std::vector<timing> timings;
+
+    // The best of a few runs, to keep one slow run from standing out.
+    auto run = [&timings](const std::string &path, const std::string &input) {
+        double best = 1e300;
+        for (int i = 0; i < 3; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            LLVMFuzzerTestOneInput(reinterpret_cast<const std::uint8_t *>(input.data()),
+                                   input.size());
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::min(best, elapsed.count());
+        }
+        timings.push_back({ best / static_cast<double>(std::max<std::size_t>(input.size(), 1)),
+                            input.size(), path });
+    };
+    auto load = [](const fs::path &path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::string{ std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+    };
+
+    if (paths.empty()) {
+        run("<stdin>", std::string{ std::istreambuf_iterator<char>(std::cin),
+                                    std::istreambuf_iterator<char>() });
+    }
+    for (const std::string &p : paths) {
+        if (fs::is_directory(p)) {
+            for (const auto &entry : fs::directory_iterator(p)) {
+                if (entry.is_regular_file()) {
+                    run(entry.path().string(), load(entry.path()));
+                }
+            }
+        } else {
+            run(p, load(p));
+        }
+    }
+
+    std::sort(timings.begin(), timings.end(),
+              [](const timing &t1, const timing &t2) { return t1.m_per_byte > t2.m_per_byte; });
+    timings.resize(std::min(slowest, timings.size()));
+    for (const timing &t : timings) {
+        fmt::print("{:>12.3f} ns/byte {:>10} bytes  {}\n", t.m_per_byte * 1e9, t.m_size, t.m_path);
+    }
+    return 0;
+}
+
+#endif
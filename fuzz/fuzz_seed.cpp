@@ -0,0 +1,42 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include <stan/rapidcheck/generator.hpp>
+
+#include <fmt/format.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+// Writes a seed corpus for the reader's fuzz target: columns drawn from the
+// rapidcheck generators, written as LilyPond, one to a file.  Every column the
+// notation model can hold is likely to turn up, so the fuzzer starts from
+// inputs that parse, and mutates them into ones that nearly do.
+
+namespace fs = std::filesystem;
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        std::cerr << "usage: fuzz.seed directory [count]\n";
+        return 1;
+    }
+    fs::path directory = argv[1];
+    std::size_t count = argc > 2 ? std::stoul(argv[2]) : 1000;
+    fs::create_directories(directory);
+
+    stan::lilypond::writer write;
+    rc::Gen<stan::column> columns = rc::gen::arbitrary<stan::column>();
+    for (std::size_t i = 0; i < count; ++i) {
+        // Small columns first, growing to the generators' nominal size.
+        rc::Random random({ i, 0, 0, 0 });
+        int size = static_cast<int>(i % (rc::kNominalSize + 1));
+        try {
+            std::ofstream(directory / fmt::format("seed-{:05}.ly", i))
+                << write(columns(random, size).value());
+        } catch (const rc::GenerationFailure &) {
+            // The generators filter with suchThat, which can give up.
+        }
+    }
+    return 0;
+}
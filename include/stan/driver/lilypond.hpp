@@ -1,23 +1,24 @@
 #pragma once
 
-#include <stan/notation.hpp>
-
-#include <algorithm>
-
-namespace stan {
-}
-
-namespace stan::lilypond {
-
-struct writer
-{
-    template <typename T>
-    std::string operator()(const T &) const;
-};
-
-struct reader
-{
-    column operator()(const std::string &);
-};
-
-} // namespace stan::lilypond
+#include <stan/driver/lilypond/writer.hpp>
+#include <stan/driver/lilypond/result.hpp>
+#include <stan/driver/lilypond/reader.hpp>
+#include <stan/driver/lilypond/predictive_reader.hpp>
+#include <stan/driver/lilypond/validator.hpp>
+#include <stan/driver/lilypond/event_handler.hpp>
+#include <stan/driver/lilypond/event_reader.hpp>
+#include <stan/driver/lilypond/event_writer.hpp>
+#include <stan/driver/lilypond/mapped_file.hpp>
+#include <stan/driver/lilypond/sequence_reader.hpp>
+#include <stan/driver/lilypond/sequence_writer.hpp>
+#include <stan/driver/lilypond/measure_index.hpp>
+#include <stan/driver/lilypond/push_reader.hpp>
+#include <stan/driver/lilypond/parallel_reader.hpp>
+#include <stan/driver/lilypond/parallel_writer.hpp>
+#include <stan/driver/lilypond/simultaneous_reader.hpp>
+#include <stan/driver/lilypond/include_reader.hpp>
+#include <stan/driver/lilypond/shared_music.hpp>
+#include <stan/driver/lilypond/variable_reader.hpp>
+#include <stan/driver/lilypond/batch_reader.hpp>
+#include <stan/driver/lilypond/skeleton.hpp>
+#include <stan/driver/lilypond/incremental_reader.hpp>
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond/reader.hpp>
+#include <stan/driver/lilypond/result.hpp>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace stan {
+class thread_pool;
+}
+
+namespace stan::lilypond {
+
+// Parses many short, independent snippets on a thread pool.  Every thread
+// gets a reader of its own, with its own arena, and keeps it from one batch
+// to the next, so the per-call setup of a reader is paid once per thread
+// rather than once per snippet.
+
+class batch_reader
+{
+  public:
+    explicit batch_reader(thread_pool &pool);
+    ~batch_reader();
+
+    // Free the arenas of every thread, as reader::release does.  The results
+    // of earlier batches must be destroyed first; copies of their columns
+    // stay valid.
+    void release();
+
+    // One result per snippet, in the same order.  The columns are allocated
+    // from the arenas, and stay valid until release() is called.
+    std::vector<result<column>> operator()(const std::vector<std::string_view> &snippets);
+    std::vector<result<column>> operator()(const std::vector<std::string> &snippets);
+
+  private:
+    thread_pool &m_pool;
+    std::vector<reader> m_readers;
+};
+
+} // namespace stan::lilypond
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stan/notation.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace stan::lilypond {
+
+// The pitches of a chord event, as a view of storage that belongs to the
+// sender and is only valid during the call.
+
+class pitch_span
+{
+  public:
+    pitch_span(const pitch *first, std::size_t size) :
+        m_first(first), m_size(size) {}
+
+    const pitch *begin() const { return m_first; }
+    const pitch *end() const { return m_first + m_size; }
+    std::size_t size() const { return m_size; }
+    const pitch &operator[](std::size_t i) const { return m_first[i]; }
+
+  private:
+    const pitch *m_first;
+    std::size_t m_size;
+};
+
+// Receives music one construct at a time, in source order, without a tree of
+// columns ever being built.  Every member does nothing by default, so a
+// handler overrides only the events it cares about.
+
+struct event_handler
+{
+    virtual ~event_handler() = default;
+
+    virtual void on_rest(const rest &) {}
+    virtual void on_note(const note &) {}
+
+    // The pitches are sorted, as a chord holds them.
+    virtual void on_chord(const value &, pitch_span) {}
+
+    // The elements of a beam or tuplet are the events between its begin and
+    // its end.  A tuplet begins with its ratio, num/den, as it was written.
+    virtual void begin_beam() {}
+    virtual void end_beam() {}
+    virtual void begin_tuplet(int, int) {}
+    virtual void end_tuplet() {}
+
+    virtual void on_meter(std::uint8_t, const value &) {}
+    virtual void on_clef(const clef &) {}
+    virtual void on_key(pitchclass, mode::id) {}
+};
+
+// A handler that passes every event on to another one, as the base of a
+// filter that changes or drops only some of them.
+
+struct event_filter : event_handler
+{
+    explicit event_filter(event_handler &next) :
+        m_next(next) {}
+
+    void on_rest(const rest &r) override { m_next.on_rest(r); }
+    void on_note(const note &n) override { m_next.on_note(n); }
+
+    void on_chord(const value &v, pitch_span pitches) override { m_next.on_chord(v, pitches); }
+
+    void begin_beam() override { m_next.begin_beam(); }
+    void end_beam() override { m_next.end_beam(); }
+    void begin_tuplet(int num, int den) override { m_next.begin_tuplet(num, den); }
+    void end_tuplet() override { m_next.end_tuplet(); }
+
+    void on_meter(std::uint8_t beats, const value &v) override { m_next.on_meter(beats, v); }
+    void on_clef(const clef &c) override { m_next.on_clef(c); }
+
+    void on_key(pitchclass tonic, mode::id id) override { m_next.on_key(tonic, id); }
+
+  protected:
+    event_handler &m_next;
+};
+
+} // namespace stan::lilypond
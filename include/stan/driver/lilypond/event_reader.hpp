@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond/event_handler.hpp>
+
+#include <string_view>
+#include <vector>
+
+namespace stan::lilypond {
+
+// Sends the events of any number of whitespace separated columns, without the
+// braces of a sequence as for reader::append, to a handler.  It parses like
+// predictive_reader, and throws the same exceptions for malformed input, but
+// only after the events of everything before the error have been sent.  The
+// rules that the notation objects check when they are constructed are checked
+// as well, with the validator's state machine, so input that reader rejects
+// is rejected here too, with an exception of the same type.
+//
+// The only memory allocated is the reader's buffer for chord pitches, which
+// is reused from one chord to the next.
+
+class event_reader
+{
+  public:
+    void operator()(std::string_view, event_handler &);
+
+  private:
+    std::vector<pitch> m_pitches;
+};
+
+} // namespace stan::lilypond
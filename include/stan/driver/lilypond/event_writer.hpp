@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond/event_handler.hpp>
+
+#include <cstdint>
+#include <string>
+
+namespace stan::lilypond {
+
+// Writes events as LilyPond, appending to a string that the caller owns.
+// Each column is written exactly as writer would write it, and columns are
+// separated by single spaces.  A tuplet's ratio is written reduced, as a
+// tuplet holds it.  Apart from growing the string, nothing is
+// allocated.
+
+class event_writer : public event_handler
+{
+  public:
+    explicit event_writer(std::string &lily) :
+        m_lily(lily) {}
+
+    void on_rest(const rest &) override;
+    void on_note(const note &) override;
+    void on_chord(const value &, pitch_span) override;
+    void begin_beam() override;
+    void end_beam() override;
+    void begin_tuplet(int num, int den) override;
+    void end_tuplet() override;
+    void on_meter(std::uint8_t beats, const value &) override;
+    void on_clef(const clef &) override;
+    void on_key(pitchclass tonic, mode::id) override;
+
+  private:
+    // Called before each column.
+    void separate();
+
+    std::string &m_lily;
+    bool m_first = true;
+};
+
+} // namespace stan::lilypond
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stan/notation.hpp>
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace stan {
+class thread_pool;
+}
+
+namespace stan::lilypond {
+
+// Reads a score whose top level sequence is split over several files, joined
+// with \include "path".  The file named in the call holds the sequence,
+// "{ ... }", and every file it includes holds columns without braces, which
+// take the place of the \include.  Included files may include others in turn.
+// An \include is recognized at the top level of a file only, and paths are
+// relative to the directory of the file that includes them.
+//
+// The files are found and parsed one level of the include graph at a time,
+// with every file on a level parsed concurrently on a thread pool.  Each
+// file's columns are cached, keyed by its canonical path, modification time
+// and a hash of its contents.  On the next call, a file whose time and size
+// are unchanged is not even read, and one whose contents hash the same is not
+// parsed, so reading a score again after editing one file costs about as much
+// as parsing that one file.
+
+class include_reader
+{
+  public:
+    // A run of consecutive columns from one file.  The columns are shared
+    // with the cache, and stay valid as long as the run does, even if the
+    // file is parsed again.
+    struct run
+    {
+        std::shared_ptr<const std::vector<column>> m_columns;
+        std::size_t m_first;
+        std::size_t m_last;
+
+        const column *begin() const { return m_columns->data() + m_first; }
+        const column *end() const { return m_columns->data() + m_last; }
+    };
+
+    explicit include_reader(thread_pool &pool);
+    ~include_reader();
+
+    // The columns of the score, in order, as runs.  Throws stan::exception if
+    // a file cannot be read or includes itself, and std::runtime_error for
+    // malformed input, as sequence_reader does.
+    std::vector<run> operator()(const std::string &path);
+
+    // The number of files that the last call parsed, rather than taking
+    // their columns from the cache.
+    std::size_t parsed() const { return m_parsed; }
+
+    // The cache entry for one file, defined in include_reader.cpp.
+    struct file;
+
+  private:
+    std::vector<run> flatten(const std::string &path, std::vector<std::string> &stack) const;
+
+    thread_pool &m_pool;
+    std::map<std::string, std::unique_ptr<file>> m_files;
+    std::size_t m_parsed = 0;
+};
+
+} // namespace stan::lilypond
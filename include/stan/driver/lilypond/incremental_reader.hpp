@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond/result.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace stan::lilypond {
+
+class builder;
+
+// Keeps the parse of an editor buffer up to date as it is edited.  The buffer
+// holds the columns of a sequence, without the braces, as for reader::append.
+// The reader remembers the byte range of every top level column, so after an
+// edit, only the columns that the edit touches, and their immediate
+// neighbours, are parsed again, and the results are spliced in place of the
+// old ones.  Parsing always runs in recovery mode, so a buffer with errors in
+// it is still parsed everywhere else.  A bracket that nothing closes, or that
+// closes nothing, is an error of its own, as for reader::recover.  So an edit
+// whose brackets do not balance only reaches as far as the brackets it pairs
+// with: a closing bracket takes in the columns back to the opening bracket it
+// now closes, and an opening bracket the columns up to the closing bracket
+// that now closes it, if there are any.
+//
+// The columns are kept in small blocks.  Offsets within a block are relative
+// to its start, and the starts themselves are prefix sums over the blocks, in
+// a Fenwick tree, as are the counts of unmatched brackets that find where an
+// unbalanced edit reaches.  So splicing touches only the blocks it replaces,
+// and the tree in O(log n).  Apart from the text itself, which is a
+// std::string that is spliced at memmove speed, the cost of an edit does not
+// grow with the size of the document, except by the text it encloses.
+
+class incremental_reader
+{
+  public:
+    explicit incremental_reader(std::string lily = {});
+    incremental_reader(incremental_reader &&) noexcept;
+    incremental_reader &operator=(incremental_reader &&) noexcept;
+    ~incremental_reader();
+
+    // Replace length bytes at offset with text, and bring the parse up to
+    // date.  Throws std::out_of_range if the range is not within the buffer.
+    void edit(std::size_t offset, std::size_t length, std::string_view text);
+
+    const std::string &text() const { return m_text; }
+
+    // The columns that parsed, and the errors for those that did not, in
+    // order.
+    std::vector<column> music() const;
+    std::vector<parse_error> errors() const;
+
+    struct extent
+    {
+        std::size_t m_first;
+        std::size_t m_last;
+    };
+
+    // The byte range of every column and error, in order.
+    std::vector<extent> extents() const;
+
+  private:
+    struct block;
+    struct position;
+
+    position first_ending_from(std::size_t offset) const;
+    position first_beginning_after(std::size_t offset) const;
+    std::size_t start(std::size_t block) const;
+    std::size_t block_at(std::size_t offset) const;
+    extent absolute(const position &) const;
+
+    // The item that holds the nth unmatched opening bracket back from the one
+    // at p, or the nth unmatched closing bracket on from it, which has moved
+    // by delta bytes; the last one there is if there are fewer than n.
+    std::optional<position> opening_before(position p, std::size_t n) const;
+    std::optional<position> closing_after(position p, std::size_t n,
+                                          std::size_t delta) const;
+    void next(position &) const;
+    void previous(position &) const;
+
+    // Parse [first, last) of m_text into items to replace [from, to).
+    // Everything after to moves by delta bytes.
+    void splice(std::size_t first, std::size_t last, position from, position to,
+                std::size_t delta);
+
+    // Rebuild the Fenwick trees from m_blocks.
+    void index();
+
+    std::string m_text;
+    std::vector<block> m_blocks;
+
+    // Fenwick trees over the blocks: the bytes from the start of each block
+    // to the start of the next, and its unmatched closing and opening
+    // brackets.
+    std::vector<std::size_t> m_spans;
+    std::vector<std::size_t> m_closing;
+    std::vector<std::size_t> m_opening;
+
+    std::unique_ptr<builder> m_builder;
+};
+
+} // namespace stan::lilypond
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond/tokens.hpp>
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace stan::lilypond {
+
+// Music known when the program is compiled can be written as a literal, such
+// as "c'4 d'4"_ly, which the compiler parses.  Reading it costs nothing at
+// startup, and a literal that is not valid LilyPond does not compile.  The
+// text decides the type of the literal: a value ("4."), a pitch ("c'"), a
+// rest ("r4"), a note ("c'4"), a clef ("\clef bass"), a key ("\key d
+// \minor"), or else a phrase of several of those columns ("c'4 d'4 r2").
+// Chords, beams, tuplets and meters own vectors, which cannot be built in a
+// constant expression, so they cannot be literals.
+
+template <std::size_t N>
+struct phrase
+{
+    using element = std::variant<rest, note, clef, key>;
+
+    std::array<element, N> m_columns;
+
+    // The columns as a reader returns them.
+    std::vector<column> columns() const
+    {
+        std::vector<column> music;
+        music.reserve(N);
+        for (const element &e : m_columns) {
+            std::visit([&music](const auto &c) { music.emplace_back(c); }, e);
+        }
+        return music;
+    }
+};
+
+// The parser behind the literals.  It accepts the same language as reader,
+// less the columns that own vectors, and fails by throwing, which in a
+// constant expression is a compile error.  Pitches and values are read by
+// the same token routines as the predictive parser.
+class literal_parser
+{
+  public:
+    using element = phrase<0>::element;
+
+    constexpr explicit literal_parser(std::string_view lily) :
+        m_begin(lily.data()), m_first(lily.data()), m_last(lily.data() + lily.size()) {}
+
+    constexpr bool done()
+    {
+        skip();
+        return m_first == m_last;
+    }
+
+    constexpr std::size_t position() const { return m_first - m_begin; }
+
+    constexpr bool starts_value()
+    {
+        return !done() and *m_first >= '0' and *m_first <= '9';
+    }
+
+    constexpr bool starts_pitch()
+    {
+        return !done() and *m_first >= 'a' and *m_first <= 'g';
+    }
+
+    constexpr stan::pitch pitch() { return expect(token::pitch(m_first, m_last)); }
+    constexpr stan::value value() { return expect(token::value(m_first, m_last)); }
+
+    constexpr element column()
+    {
+        if (done()) {
+            throw std::runtime_error("parse error");
+        }
+        if (next('r')) {
+            return rest{ value() };
+        }
+        if (next('\\')) {
+            if (word("clef")) {
+                return clef{ clef_type() };
+            }
+            if (word("key")) {
+                stan::pitchclass tonic = expect(token::pitchclass(m_first, m_last));
+                return key{ tonic, mode() };
+            }
+            if (word("tuplet") or word("time")) {
+                throw std::runtime_error("only rests, notes, clefs and keys can be literals");
+            }
+            throw std::runtime_error("parse error");
+        }
+        if (*m_first == '<' or *m_first == '[') {
+            throw std::runtime_error("only rests, notes, clefs and keys can be literals");
+        }
+        stan::pitch p = pitch();
+        return note{ value(), p };
+    }
+
+    // The whole text as a single value, pitch or column.
+    template <typename T>
+    constexpr T whole()
+    {
+        T t = parse(static_cast<T *>(nullptr));
+        if (!done()) {
+            throw std::runtime_error("incomplete parse");
+        }
+        return t;
+    }
+
+    static constexpr std::size_t count(std::string_view lily)
+    {
+        literal_parser p(lily);
+        std::size_t n = 0;
+        while (!p.done()) {
+            p.column();
+            ++n;
+        }
+        if (n == 0) {
+            throw std::runtime_error("parse error");
+        }
+        return n;
+    }
+
+    // The kinds of literal, by the text they hold.
+    enum struct kind
+    {
+        value,
+        pitch,
+        column,
+        phrase
+    };
+
+    static constexpr kind classify(std::string_view lily)
+    {
+        literal_parser p(lily);
+        if (p.starts_value()) {
+            return kind::value;
+        }
+        if (p.starts_pitch()) {
+            p.pitch();
+            if (p.done()) {
+                return kind::pitch;
+            }
+        }
+        return count(lily) == 1 ? kind::column : kind::phrase;
+    }
+
+    template <std::size_t N>
+    static constexpr phrase<N> parse_phrase(std::string_view lily)
+    {
+        // Find where each column begins, so that each element of the phrase
+        // can be initialized from its own text.
+        std::array<std::size_t, N> first{};
+        literal_parser p(lily);
+        for (std::size_t &f : first) {
+            p.skip();
+            f = p.position();
+            p.column();
+        }
+        return elements<N>(lily, first, std::make_index_sequence<N>());
+    }
+
+  private:
+    constexpr void skip() { token::skip(m_first, m_last); }
+    constexpr bool next(char c) { return token::next(m_first, m_last, c); }
+
+    template <typename T>
+    static constexpr T expect(const std::optional<T> &t)
+    {
+        if (!t) {
+            throw std::runtime_error("parse error");
+        }
+        return *t;
+    }
+
+    constexpr bool word(std::string_view w)
+    {
+        skip();
+        if (std::string_view(m_first, m_last - m_first).substr(0, w.size()) != w) {
+            return false;
+        }
+        m_first += w.size();
+        return true;
+    }
+
+    constexpr clef::type clef_type()
+    {
+        constexpr std::pair<std::string_view, clef::type> types[] = {
+            { "treble", clef::type::treble }, { "alto", clef::type::alto },
+            { "tenor", clef::type::tenor },   { "bass", clef::type::bass },
+            { "percussion", clef::type::percussion },
+        };
+        for (const auto &[name, type] : types) {
+            if (word(name)) {
+                return type;
+            }
+        }
+        throw std::runtime_error("parse error");
+    }
+
+    constexpr key::degrees mode()
+    {
+        if (word("\\major")) {
+            return mode::major_degrees;
+        }
+        if (word("\\minor")) {
+            return mode::minor_degrees;
+        }
+        throw std::runtime_error("parse error");
+    }
+
+    constexpr stan::value parse(stan::value *) { return value(); }
+    constexpr stan::pitch parse(stan::pitch *) { return pitch(); }
+    constexpr element parse(element *) { return column(); }
+
+    template <std::size_t N, std::size_t... I>
+    static constexpr phrase<N> elements(std::string_view lily,
+                                        const std::array<std::size_t, N> &first,
+                                        std::index_sequence<I...>)
+    {
+        return { { literal_parser(lily.substr(first[I])).column()... } };
+    }
+
+    const char *m_begin;
+    const char *m_first;
+    const char *m_last;
+};
+
+// The characters of a literal, as a constant that outlives the parse.
+template <char... Chars>
+struct literal_text
+{
+    static constexpr char data[] = { Chars..., '\0' };
+    static constexpr std::string_view view{ data, sizeof...(Chars) };
+};
+
+namespace literals {
+
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wgnu-string-literal-operator-template"
+#endif
+
+// Every parse is the initializer of a constexpr variable, so it happens at
+// compile time even where the literal is used at run time.
+template <typename Char, Char... Chars>
+constexpr auto operator""_ly()
+{
+    static_assert(std::is_same_v<Char, char>, "LilyPond literals are narrow strings");
+
+    using text = literal_text<Chars...>;
+    using kind = literal_parser::kind;
+    constexpr kind k = literal_parser::classify(text::view);
+    if constexpr (k == kind::value) {
+        constexpr value v = literal_parser(text::view).whole<value>();
+        return v;
+    } else if constexpr (k == kind::pitch) {
+        constexpr pitch p = literal_parser(text::view).whole<pitch>();
+        return p;
+    } else if constexpr (k == kind::column) {
+        constexpr auto c = literal_parser(text::view).whole<literal_parser::element>();
+        return std::get<c.index()>(c);
+    } else {
+        constexpr auto p =
+            literal_parser::parse_phrase<literal_parser::count(text::view)>(text::view);
+        return p;
+    }
+}
+
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif
+
+} // namespace literals
+
+} // namespace stan::lilypond
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace stan::lilypond {
+
+// Read-only memory mapping of a whole file, so the reader can run directly
+// over the mapped bytes without first copying the file into a std::string.
+// Sizes are std::size_t throughout, so files larger than 4 GiB work too.
+
+class mapped_file
+{
+  public:
+    explicit mapped_file(const std::string &path);
+    mapped_file(mapped_file &&) noexcept;
+    mapped_file &operator=(mapped_file &&) noexcept;
+    ~mapped_file();
+
+    std::string_view view() const { return { m_data, m_size }; }
+    std::size_t size() const { return m_size; }
+
+  private:
+    const char *m_data = nullptr;
+    std::size_t m_size = 0;
+};
+
+} // namespace stan::lilypond
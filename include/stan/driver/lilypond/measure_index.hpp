@@ -0,0 +1,96 @@
+#pragma once
+
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond/reader.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace stan::lilypond {
+
+// Where every measure of a top level sequence begins, so that a range of
+// measures can be parsed without parsing everything before them.  The index
+// is built by a single streaming pass over the file, which splits it where the
+// boundary scanner does and parses the columns one at a time to add up their
+// durations, and is kept in a sidecar file next to the source.
+//
+// Measures are counted from the meters in the music, starting in 4/4, with
+// treble clef and C major in effect, as in LilyPond.  A column that crosses a
+// bar line belongs to the measure it begins in, and a measure that begins
+// inside a column begins at the column after it.
+//
+// The sidecar has a versioned binary format, little endian throughout:
+//
+//     "stan.idx"                      magic
+//     u32 version, u32 zero
+//     u64 size, i64 mtime, u64 hash   of the source, to detect changes
+//     u64 end                         byte offset of the closing brace
+//     u64 count                       of measures, then count times:
+//     u64 offset, u8 tonic, u8 mode, u8 clef, u8 beats, u8 value, 3 x u8 zero
+//     u64 checksum                    FNV-1a of everything before it
+//
+// where the hash is the 64 bit FNV-1a of the whole source, mode is 0 for
+// major and 1 for minor, clef is a clef::type, and value is the denominator
+// of the meter's value.  A sidecar whose checksum or fields do not check out
+// is damaged, and open() builds the index again.
+
+class measure_index
+{
+  public:
+    static constexpr std::uint32_t version = 2;
+
+    // The start of a measure, and what is in effect there.
+    struct bar
+    {
+        std::uint64_t m_offset;
+        pitchclass m_tonic;
+        std::uint8_t m_mode;
+        clef::type m_clef;
+        std::uint8_t m_beats;
+        std::uint8_t m_value;
+    };
+
+    // Index the sequence in the file at path.  Throws as sequence_reader
+    // does for malformed input.
+    static measure_index build(const std::string &path);
+
+    // Read a sidecar file, throwing stan::exception if it cannot be read, is
+    // not an index, is of another version, or is damaged.
+    static measure_index load(const std::string &sidecar);
+
+    void save(const std::string &sidecar) const;
+
+    // The index of the file at path, from its sidecar, path + ".idx", if that
+    // is current, and otherwise built and saved there.
+    static measure_index open(const std::string &path);
+
+    // Whether the file at path is still the one that was indexed.  The size
+    // and modification time are checked first; only if the time differs is
+    // the file read to compare its hash.
+    bool current(const std::string &path) const;
+
+    std::size_t size() const { return m_bars.size(); }
+    const bar &operator[](std::size_t measure) const { return m_bars[measure]; }
+
+    stan::key key(std::size_t measure) const;
+    stan::clef clef(std::size_t measure) const;
+    stan::meter meter(std::size_t measure) const;
+
+    // Parse the measures [first, last), counted from zero, from the text of
+    // the indexed file.  Throws stan::exception if the text is not the size
+    // of the indexed file, or the range is out of bounds.
+    std::vector<column> measures(std::string_view lily, std::size_t first, std::size_t last,
+                                 reader &read) const;
+
+  private:
+    std::uint64_t m_size = 0;
+    std::int64_t m_time = 0;
+    std::uint64_t m_hash = 0;
+    std::uint64_t m_end = 0;
+    std::vector<bar> m_bars;
+};
+
+} // namespace stan::lilypond
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stan/notation.hpp>
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace stan {
+class thread_pool;
+}
+
+namespace stan::lilypond {
+
+// Parses a whole top level sequence, "{ ... }", on a thread pool.  The body of
+// the sequence is split into chunks at top level column boundaries, which are
+// found by tracking the nesting depth of '[' ']', '{' '}' and '<' '>'.  The
+// chunks are parsed concurrently, and the columns are returned in source
+// order.  The result is identical to draining a sequence_reader, including
+// the exception thrown for malformed input.
+
+class parallel_reader
+{
+  public:
+    // Chunks smaller than minimum_chunk bytes are not worth a trip through
+    // the thread pool.
+    explicit parallel_reader(thread_pool &pool, std::size_t minimum_chunk = 64 * 1024);
+
+    std::vector<column> operator()(std::string_view);
+
+  private:
+    thread_pool &m_pool;
+    std::size_t m_minimum_chunk;
+};
+
+} // namespace stan::lilypond
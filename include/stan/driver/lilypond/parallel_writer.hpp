@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stan/notation.hpp>
+
+#include <fmt/format.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace stan {
+class thread_pool;
+}
+
+namespace stan::lilypond {
+
+// Writes a whole top level sequence, "{ ... }", on a thread pool, byte for byte
+// as sequence_writer writes it.  The columns are split into contiguous ranges,
+// several per thread, which are formatted into buffers of their own at the
+// same time and then joined in order.  Written to a file descriptor, the
+// buffers are not joined; once the sizes of all of them are known, each is
+// written at its own offset with pwrite(), again at the same time.
+//
+// A column that cannot be written throws as it would from the writer; if
+// several cannot, the exception is the one for the first of them.
+
+class parallel_writer
+{
+  public:
+    // Ranges smaller than minimum_range columns are not worth a trip through
+    // the thread pool.
+    explicit parallel_writer(thread_pool &pool, std::size_t minimum_range = 4096);
+
+    std::string operator()(const std::vector<column> &music) const;
+
+    // Written from the current offset of fd, which is left at the end of the
+    // sequence.  fd must be a file that pwrite() can write to.  Write errors
+    // throw stan::exception.
+    void operator()(const std::vector<column> &music, int fd) const;
+
+  private:
+    std::vector<fmt::memory_buffer> format(const std::vector<column> &music) const;
+
+    thread_pool &m_pool;
+    std::size_t m_minimum_range;
+};
+
+} // namespace stan::lilypond
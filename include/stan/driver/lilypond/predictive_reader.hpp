@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stan/notation.hpp>
+
+#include <memory>
+#include <string_view>
+
+namespace stan::lilypond {
+
+class builder;
+
+// Hand written, single pass alternative to reader.  Each alternative of the
+// grammar is chosen from the first byte or two of input, and keywords are
+// matched through perfect hash tables, so it never backtracks.  It accepts
+// the same language as reader, produces identical results, and reports
+// errors with the same exceptions.
+
+struct predictive_reader
+{
+    predictive_reader();
+    predictive_reader(predictive_reader &&) noexcept;
+    predictive_reader &operator=(predictive_reader &&) noexcept;
+    ~predictive_reader();
+
+    column operator()(std::string_view);
+
+  private:
+    std::unique_ptr<builder> m_builder;
+};
+
+} // namespace stan::lilypond
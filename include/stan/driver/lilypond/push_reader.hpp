@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stan/notation.hpp>
+
+#include <functional>
+#include <memory>
+#include <string_view>
+
+namespace stan::lilypond {
+
+// Push-style reader for a top-level music sequence, for input that arrives in
+// pieces, such as from a pipe.  The pieces may be of any size and may split a
+// token anywhere, even "\tuplet" or "dss'''".  A column is complete when the
+// next one begins, at which point it is parsed and handed to the handler;
+// the last one is handed over by finish().  Only the text of the column that
+// is not yet complete is buffered, so memory depends on the size of the
+// pieces and of the largest column, not on the size of the document.
+//
+// Columns are found as by the boundary scanner, and the text between two
+// boundaries is read as any number of columns, so columns that are not
+// separated by whitespace, as in "d4[e8 f8]", are read as sequence_reader
+// reads them.  Malformed input throws from feed() or finish() with the same
+// exceptions as sequence_reader, after which the push_reader must not be used
+// again.
+
+class push_reader
+{
+  public:
+    using handler = std::function<void(column &&)>;
+
+    explicit push_reader(handler h);
+    push_reader(push_reader &&) noexcept;
+    push_reader &operator=(push_reader &&) noexcept;
+    ~push_reader();
+
+    void feed(std::string_view lily);
+
+    // The end of the input.  Throws if the sequence is not closed.
+    void finish();
+
+  private:
+    struct state;
+    std::unique_ptr<state> m_state;
+};
+
+} // namespace stan::lilypond
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond/result.hpp>
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace stan::lilypond {
+
+class builder;
+
+// Tag for constructing a reader that allocates from its own arena.
+struct arena_t
+{
+};
+inline constexpr arena_t arena{};
+
+struct reader
+{
+    reader();
+
+    // Allocate every node of every column this reader returns from an arena
+    // that the reader owns, until release() is called.  The arena grows to
+    // fit everything allocated between two calls to release(), up to 16 MiB,
+    // so a warmed up reader parses without touching the heap at all.  It
+    // shrinks again once several releases in a row used little of it.
+    explicit reader(arena_t);
+
+    reader(reader &&) noexcept;
+    reader &operator=(reader &&) noexcept;
+    ~reader();
+
+    // Free everything in the arena in one shot.  Columns the reader returned
+    // earlier must not be used afterwards, but copies of them do not use the
+    // arena and stay valid.  Does nothing for a reader without an arena.
+    void release();
+
+    column operator()(std::string_view);
+
+    // Like operator(), but errors are returned rather than thrown.  Syntax
+    // errors do not throw at all; if the notation model rejects an object,
+    // its exception is caught and returned as well.
+    result<column> parse(std::string_view);
+
+    // Parse any number of whitespace separated columns, without the braces
+    // of a sequence, appending them to music in order.
+    void append(std::string_view, std::vector<column> &music);
+
+    // Recovery mode for append.  A column that fails to parse is skipped up
+    // to the next top level column boundary, and parsing resumes there.  Every
+    // column that parses is appended to music, and an error is returned for
+    // each one that does not, in order.  A bracket that nothing closes, or
+    // that closes nothing, is an error of its own, and otherwise reads as
+    // whitespace, so that it does not take the rest of the input with it.
+    std::vector<parse_error> recover(std::string_view, std::vector<column> &music);
+
+  private:
+    class memory;
+
+    // Declared before the builder, which may hold columns that point into
+    // the arena, so that it is destroyed after the builder.
+    std::unique_ptr<memory> m_arena;
+
+    // Scratch space for the parse, reused from one call to the next so that
+    // a warmed up reader allocates only for the notation objects it returns.
+    std::unique_ptr<builder> m_builder;
+};
+
+} // namespace stan::lilypond
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+
+namespace stan::lilypond {
+
+// Why some input could not be read, for the non-throwing reader interface.
+struct parse_error
+{
+    // Byte offset into the input where the failure was detected.
+    std::size_t m_offset;
+
+    // Name of the grammar rule or token that was expected at m_offset, such
+    // as "value" or "']'".  If the notation model rejected an object, this is
+    // the rule that built it.
+    std::string_view m_expected;
+
+    // "parse error", "incomplete parse", or the message of the notation
+    // exception that rejected the object.
+    std::string m_message;
+};
+
+// Either a T or a parse_error, in the manner of std::expected.
+template <typename T>
+class result
+{
+  public:
+    result(T &&v) :
+        m_result(std::in_place_index<0>, std::move(v)) {}
+    result(parse_error &&e) :
+        m_result(std::in_place_index<1>, std::move(e)) {}
+
+    bool has_value() const { return m_result.index() == 0; }
+    explicit operator bool() const { return has_value(); }
+
+    // Throws the same exception the throwing interface would have, except
+    // that a notation error is reported as a std::runtime_error.
+    T &value()
+    {
+        if (!has_value()) {
+            throw std::runtime_error(error().m_message);
+        }
+        return std::get<0>(m_result);
+    }
+
+    const T &value() const
+    {
+        if (!has_value()) {
+            throw std::runtime_error(error().m_message);
+        }
+        return std::get<0>(m_result);
+    }
+
+    T &operator*() { return std::get<0>(m_result); }
+    const T &operator*() const { return std::get<0>(m_result); }
+    T *operator->() { return &std::get<0>(m_result); }
+    const T *operator->() const { return &std::get<0>(m_result); }
+
+    parse_error &error() { return std::get<1>(m_result); }
+    const parse_error &error() const { return std::get<1>(m_result); }
+
+  private:
+    std::variant<T, parse_error> m_result;
+};
+
+} // namespace stan::lilypond
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond/mapped_file.hpp>
+
+#include <cstddef>
+#include <iosfwd>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+namespace stan::lilypond {
+
+// Pull-style reader for a top-level music sequence, like "{ c4 d4 [e8 f8] }".
+// A whole movement may contain tens of thousands of columns, so instead of
+// parsing everything up front, each column is parsed only when it is asked
+// for.  The first column is available before the rest of the input has even
+// been read, and memory is bounded by the largest single column rather than
+// by the size of the input.
+
+class sequence_reader
+{
+  public:
+    class iterator;
+
+    explicit sequence_reader(std::istream &);
+
+    // Parse in place; the characters must outlive the sequence_reader.
+    explicit sequence_reader(std::string_view);
+
+    // Parse a memory mapped file in place.  The sequence_reader takes
+    // ownership of the mapping.
+    explicit sequence_reader(mapped_file &&);
+
+    sequence_reader(sequence_reader &&) noexcept;
+    sequence_reader &operator=(sequence_reader &&) noexcept;
+    ~sequence_reader();
+
+    // Parse the next column of the sequence.  Returns an empty optional after
+    // the closing brace, and throws on malformed input just like reader does.
+    std::optional<column> next();
+
+    iterator begin();
+    iterator end();
+
+    // Type erased parser state, specialized in lilypond_reader.cpp for each
+    // kind of input iterator.
+    struct source;
+
+  private:
+    std::unique_ptr<source> m_source;
+};
+
+class sequence_reader::iterator
+{
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = column;
+    using difference_type = std::ptrdiff_t;
+    using pointer = column *;
+    using reference = column &;
+
+    iterator() = default;
+    explicit iterator(sequence_reader *r) :
+        m_reader(r) { ++*this; }
+
+    reference operator*() { return *m_column; }
+    pointer operator->() { return &*m_column; }
+
+    iterator &operator++()
+    {
+        m_column = m_reader->next();
+        if (!m_column) {
+            m_reader = nullptr;
+        }
+        return *this;
+    }
+
+    friend bool operator==(const iterator &i1, const iterator &i2)
+    {
+        return i1.m_reader == i2.m_reader;
+    }
+
+    friend bool operator!=(const iterator &i1, const iterator &i2)
+    {
+        return !(i1 == i2);
+    }
+
+  private:
+    sequence_reader *m_reader = nullptr;
+    std::optional<column> m_column;
+};
+
+} // namespace stan::lilypond
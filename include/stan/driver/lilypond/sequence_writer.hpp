@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stan/notation.hpp>
+
+#include <fmt/format.h>
+
+#include <array>
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+#include <string_view>
+
+namespace stan::lilypond {
+
+// Writes a top-level music sequence, "{ c4 d4 [e8 f8] }", to a file descriptor
+// or a std::ostream, as the columns are given, so that a whole score is never
+// held in memory.  The text is gathered into a few fixed buffers, which go out
+// together with one writev() when they are all full, and text that is already
+// written and larger than a buffer goes out from where it is, without a copy.
+// The file descriptor stays open.  Write errors throw stan::exception.
+//
+// finish() closes the sequence and writes out what is left.  Without it, the
+// sequence is left open and whatever is still buffered is lost.
+
+class sequence_writer
+{
+  public:
+    static constexpr std::size_t buffer_size = 64 * 1024;
+    static constexpr std::size_t buffer_count = 4;
+
+    explicit sequence_writer(int fd);
+    explicit sequence_writer(std::ostream &);
+    sequence_writer(const sequence_writer &) = delete;
+    sequence_writer &operator=(const sequence_writer &) = delete;
+    ~sequence_writer();
+
+    void operator()(const column &);
+
+    // Text already written as LilyPond, which is copied through as it is.
+    // It may be cut anywhere, but as a whole, it should be columns with a
+    // space after each, as operator() writes them.
+    void append(std::string_view lily);
+
+    void finish();
+
+  private:
+    void put(std::string_view);
+    void flush(std::string_view tail);
+
+    int m_fd = -1;
+    std::ostream *m_stream = nullptr;
+
+    std::array<std::unique_ptr<char[]>, buffer_count> m_buffers;
+    std::size_t m_buffer = 0;
+    std::size_t m_used = 0;
+
+    // The current column, as it is written.
+    fmt::memory_buffer m_column;
+};
+
+} // namespace stan::lilypond
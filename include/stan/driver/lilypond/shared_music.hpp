@@ -0,0 +1,133 @@
+#pragma once
+
+#include <stan/notation.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace stan::lilypond {
+
+// A sequence of columns in which the music of a variable appears by reference
+// rather than as a copy.  Music is a list of parts, each either a run of the
+// music's own columns or a whole other shared_music, so a variable that is
+// referenced a hundred times costs one shared_ptr per reference, and memory
+// grows with the unique material rather than with the expanded length.
+//
+// A repeat is a part too: the body is held once, along with the number of
+// times it is played, so neither memory nor the duration depends on the
+// count.  The expanded sequence is produced only on demand, by for_each or by
+// iterating, for a consumer that needs every column in turn, such as MIDI
+// export.  Shared music is never modified once it has been read.
+
+struct shared_music
+{
+    class iterator;
+
+    struct part
+    {
+        // The music of a variable or the body of a repeat, or null for the
+        // columns [m_first, m_last) of m_columns.
+        std::shared_ptr<const shared_music> m_music;
+        std::size_t m_first;
+        std::size_t m_last;
+
+        // The number of times m_music is played in a row.
+        std::uint32_t m_count = 1;
+    };
+
+    std::vector<column> m_columns;
+    std::vector<part> m_parts;
+
+    // Number of columns, and their total duration, with every part expanded.
+    // Both are kept up to date as parts are added, so they are known without
+    // walking anything.
+    std::size_t m_size = 0;
+    duration m_duration = duration::zero();
+
+    // Call f with every column in order, expanding parts as they come.
+    template <typename Function>
+    void for_each(Function &&f) const
+    {
+        for (const part &p : m_parts) {
+            if (p.m_music) {
+                for (std::uint32_t i = 0; i < p.m_count; ++i) {
+                    p.m_music->for_each(f);
+                }
+            } else {
+                for (std::size_t i = p.m_first; i < p.m_last; ++i) {
+                    f(m_columns[i]);
+                }
+            }
+        }
+    }
+
+    iterator begin() const;
+    iterator end() const;
+
+    // A deep copy of every column, in order.
+    std::vector<column> expand() const;
+};
+
+// Walks the expansion of shared music one column at a time, keeping a stack
+// of the parts it is in, so memory depends on how deeply references and
+// repeats nest rather than on the length of the expansion.
+
+class shared_music::iterator
+{
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = column;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const column *;
+    using reference = const column &;
+
+    iterator() = default;
+
+    reference operator*() const { return *m_column; }
+    pointer operator->() const { return m_column; }
+
+    iterator &operator++();
+
+    iterator operator++(int)
+    {
+        iterator i = *this;
+        ++*this;
+        return i;
+    }
+
+    // Every column of the expansion has a different index, even one that
+    // repeats, and the end has the index one past the last column.
+    friend bool operator==(const iterator &i1, const iterator &i2)
+    {
+        return i1.m_index == i2.m_index;
+    }
+
+    friend bool operator!=(const iterator &i1, const iterator &i2)
+    {
+        return !(i1 == i2);
+    }
+
+  private:
+    friend struct shared_music;
+
+    struct frame
+    {
+        const shared_music *m_music;
+        std::size_t m_part;
+
+        // The column within the current part, or the repetition of its music.
+        std::size_t m_position;
+    };
+
+    // Find the column at the current position, or the next one after it.
+    void settle();
+
+    std::vector<frame> m_stack;
+    const column *m_column = nullptr;
+    std::size_t m_index = 0;
+};
+
+} // namespace stan::lilypond
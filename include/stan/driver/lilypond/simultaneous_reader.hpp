@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stan/notation.hpp>
+
+#include <string_view>
+#include <vector>
+
+namespace stan {
+class thread_pool;
+}
+
+namespace stan::lilypond {
+
+// Music in several voices at once, such as the staves of a score, with the
+// columns of each voice in order, and the voices in the order they were
+// written.
+
+struct simultaneous_music
+{
+    std::vector<std::vector<column>> m_voices;
+};
+
+// Reads simultaneous music, "<< { ... } { ... } >>", whose voices are each a
+// sequence.  The voices do not depend on one another, so once their extents
+// are found by matching brackets, every voice is parsed on a thread pool at
+// the same time as the others.  A score of thirty staves parses up to thirty
+// times faster than it would one voice after another, given the cores.
+//
+// Malformed input throws the same exceptions as sequence_reader.  If several
+// voices are malformed, the exception is the one for the first of them, just
+// as if they had been parsed in order.
+
+class simultaneous_reader
+{
+  public:
+    explicit simultaneous_reader(thread_pool &pool);
+
+    simultaneous_music operator()(std::string_view lily);
+
+  private:
+    thread_pool &m_pool;
+};
+
+} // namespace stan::lilypond
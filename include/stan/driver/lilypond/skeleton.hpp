@@ -0,0 +1,86 @@
+#pragma once
+
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond/reader.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace stan::lilypond {
+
+// The shape of a top level sequence, "{ ... }", without the notation objects.
+// A single pass over the bytes records the byte range and kind of every
+// column, including the elements of beams and tuplets, and nothing else, so
+// building the skeleton of a big file costs little more than reading it.  Any
+// column, at any level, can then be built into a real notation object with a
+// reader, when and if it is needed.
+//
+// Like the boundary scanner, the skeleton relies on every column being
+// preceded by whitespace or by a bracket, which is true of everything the
+// writer produces.  A column that directly follows the duration of another,
+// as in "<gf'' e>64r8", is rejected.  Beyond that and bracket balance, nothing
+// is checked until a column is built, which throws just as the reader would.
+
+class skeleton
+{
+  public:
+    // In the same order as the alternatives of column.
+    enum struct kind : std::uint8_t
+    {
+        rest,
+        note,
+        chord,
+        beam,
+        tuplet,
+        meter,
+        clef,
+        key
+    };
+
+    struct node
+    {
+        // Byte range of the column in the text, without surrounding whitespace.
+        std::size_t m_first;
+        std::size_t m_last;
+
+        kind m_kind;
+
+        // Number of nodes in the subtree rooted here, including this one.
+        // The elements of a beam or tuplet at nodes()[i] are the nodes from
+        // i + 1 to i + m_size, each followed by its own subtree.
+        std::uint32_t m_size;
+    };
+
+    // The text is not copied, so it must outlive the skeleton.  Throws
+    // std::runtime_error("parse error") if the text is not a sequence or its
+    // brackets do not balance, and stan::exception with the byte offset of a
+    // column that does not follow whitespace or a bracket.
+    explicit skeleton(std::string_view lily);
+
+    // Every column, in source order, with each beam or tuplet followed by
+    // its elements.
+    const std::vector<node> &nodes() const { return m_nodes; }
+
+    // The top level columns of the sequence.
+    std::size_t size() const { return m_columns.size(); }
+    const node &operator[](std::size_t i) const { return m_nodes[m_columns[i]]; }
+
+    std::string_view text(const node &n) const
+    {
+        return m_text.substr(n.m_first, n.m_last - n.m_first);
+    }
+
+    column build(const node &n, reader &read) const { return read(text(n)); }
+
+    // Build the top level columns [first, last).
+    std::vector<column> build(std::size_t first, std::size_t last, reader &read) const;
+
+  private:
+    std::string_view m_text;
+    std::vector<node> m_nodes;
+    std::vector<std::uint32_t> m_columns;
+};
+
+} // namespace stan::lilypond
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <stan/notation/pitch.hpp>
+#include <stan/notation/value.hpp>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+// The tokens that every LilyPond parser reads the same way: pitches, octave
+// marks and values.  They are constexpr so that the literal parser can run
+// them at compile time, and the predictive parser runs the very same code at
+// run time.  Each one skips the whitespace before it, and on success advances
+// first past what it read; on failure, first is left somewhere in the token.
+
+namespace stan::lilypond::token {
+
+// Same whitespace as x3::space: ' ', and '\t' through '\r'.
+constexpr bool is_space(char c)
+{
+    return c == ' ' or (c >= '\t' and c <= '\r');
+}
+
+constexpr void skip(const char *&first, const char *last)
+{
+    while (first != last and is_space(*first)) {
+        ++first;
+    }
+}
+
+// Whether the next token is the character c, and if so, advance past it.
+constexpr bool next(const char *&first, const char *last, char c)
+{
+    skip(first, last);
+    if (first == last or *first != c) {
+        return false;
+    }
+    ++first;
+    return true;
+}
+
+// The pitch names are a letter followed by up to two identical flats or
+// sharps.  That makes (letter, accidental) a minimal perfect hash, and the
+// pitchclass enumeration numbers each letter's names consecutively from
+// double flat to double sharp.
+constexpr std::optional<stan::pitchclass> pitchclass(const char *&first, const char *last)
+{
+    using p = stan::pitchclass;
+    constexpr std::array<p, 7> doubleflat{ p::aff, p::bff, p::cff, p::dff,
+                                           p::eff, p::fff, p::gff };
+
+    skip(first, last);
+    if (first == last or *first < 'a' or *first > 'g') {
+        return std::nullopt;
+    }
+
+    int code = static_cast<std::uint8_t>(doubleflat[*first++ - 'a']) + 2;
+    if (first != last and (*first == 'f' or *first == 's')) {
+        char a = *first++;
+        int count = 1;
+        if (first != last and *first == a) {
+            ++first;
+            ++count;
+        }
+        code += a == 's' ? count : -count;
+    }
+    return static_cast<p>(code);
+}
+
+// Up to three ticks up or four commas down; none is the octave of middle c.
+constexpr stan::octave octave(const char *&first, const char *last)
+{
+    int ticks = 0;
+    if (next(first, last, '\'')) {
+        for (ticks = 1; ticks < 3 and next(first, last, '\''); ++ticks) {
+        }
+    } else {
+        while (ticks > -4 and next(first, last, ',')) {
+            --ticks;
+        }
+    }
+    return stan::octave{ static_cast<std::uint8_t>(4 + ticks) };
+}
+
+constexpr std::optional<stan::pitch> pitch(const char *&first, const char *last)
+{
+    std::optional<stan::pitchclass> pc = pitchclass(first, last);
+    if (!pc) {
+        return std::nullopt;
+    }
+    return stan::pitch{ *pc, octave(first, last) };
+}
+
+// A value without dots, as in a meter.
+constexpr std::optional<stan::value> basevalue(const char *&first, const char *last)
+{
+    skip(first, last);
+    if (first == last) {
+        return std::nullopt;
+    }
+
+    auto then = [&first, last](char c) {
+        if (first != last and *first == c) {
+            ++first;
+            return true;
+        }
+        return false;
+    };
+
+    switch (*first++) {
+    case '1':
+        return then('6') ? value::sixteenth() : value::whole();
+    case '2':
+        return value::half();
+    case '3':
+        return then('2') ? std::optional(value::thirtysecond()) : std::nullopt;
+    case '4':
+        return value::quarter();
+    case '6':
+        return then('4') ? std::optional(value::sixtyfourth()) : std::nullopt;
+    case '8':
+        return value::eighth();
+    default:
+        return std::nullopt;
+    }
+}
+
+constexpr std::optional<stan::value> value(const char *&first, const char *last)
+{
+    std::optional<stan::value> v = basevalue(first, last);
+    if (!v) {
+        return std::nullopt;
+    }
+    stan::value dotted = *v;
+    for (int dots = 0; dots < 2 and next(first, last, '.'); ++dots) {
+        dotted = dot(dotted);
+    }
+    return dotted;
+}
+
+} // namespace stan::lilypond::token
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string_view>
+
+namespace stan::lilypond {
+
+// Whether reader would accept some input, without building anything.  The
+// same syntactic and semantic rules are checked by a state machine that keeps
+// all of its state on the stack, so it never allocates, and it answers much
+// faster than reading the input and discarding the result.
+
+struct validator
+{
+    bool operator()(std::string_view) const;
+};
+
+} // namespace stan::lilypond
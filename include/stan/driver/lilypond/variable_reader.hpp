@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond/reader.hpp>
+#include <stan/driver/lilypond/shared_music.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace stan::lilypond {
+
+// Reads a score that defines music in variables and references it, as in
+//
+//     theme = { c4 d4 }
+//     { \theme e4 \theme }
+//
+// The text holds any number of assignments, "name = { ... }", followed by the
+// sequence.  The body of each variable is parsed once, when it is assigned,
+// and every reference to it shares that one parse.  Variables may reference
+// the variables assigned before them, and an assignment to a name that is
+// already taken replaces it for the references that follow.  Names are
+// letters only, and may not be any of the commands or modes of the language.
+//
+// A sequence may also hold repeats, "\repeat unfold 16 { ... }", whose body is
+// parsed once into a part that is played the given number of times.  Volta
+// and percent repeats are played the same way as unfold repeats.
+//
+// References and repeats are recognized at the top level of a sequence only,
+// not within a beam or tuplet, whose elements are notation objects of their
+// own.  They must be preceded by whitespace, like a column in anything the
+// writer produces.
+
+class variable_reader
+{
+  public:
+    // Throws std::runtime_error for malformed input, as sequence_reader does,
+    // and stan::exception for a reference to a variable that is not defined.
+    std::shared_ptr<const shared_music> operator()(std::string_view lily);
+
+    // The variables of the score read last, by name.
+    const std::map<std::string, std::shared_ptr<const shared_music>, std::less<>> &
+    variables() const
+    {
+        return m_variables;
+    }
+
+  private:
+    // repeats is the number of repeats that enclose lily.
+    std::shared_ptr<const shared_music> body(std::string_view lily, std::size_t repeats);
+
+    // Parse the rest of a repeat after "\repeat", from lily[i] on, adding it
+    // to music.  Returns the offset just past it.
+    std::size_t repeat(std::string_view lily, std::size_t i, shared_music &music,
+                       std::size_t repeats);
+
+    // Offset in lily, which is part of m_text, of the brace that closes the
+    // one at lily[open].
+    std::size_t closing(std::string_view lily, std::size_t open) const;
+
+    reader m_reader;
+    std::map<std::string, std::shared_ptr<const shared_music>, std::less<>> m_variables;
+
+    // The score being read, and its bracket_pairs(), so that finding the end
+    // of a body does not scan it again at every level of nesting.
+    std::string_view m_text;
+    std::vector<std::pair<std::size_t, std::size_t>> m_brackets;
+};
+
+} // namespace stan::lilypond
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <string>
+
+namespace stan::lilypond {
+
+// write_to appends the text of an object to a buffer, directly, with no
+// strings built along the way, so that writing is linear in the size of the
+// output.  The other overloads write through a buffer of their own.
+
+struct writer
+{
+    template <typename T>
+    void write_to(fmt::memory_buffer &, const T &) const;
+
+    template <typename OutputIt, typename T>
+    OutputIt write_to(OutputIt out, const T &t) const
+    {
+        fmt::memory_buffer buffer;
+        write_to(buffer, t);
+        return std::copy(buffer.begin(), buffer.end(), out);
+    }
+
+    template <typename T>
+    std::string operator()(const T &t) const
+    {
+        fmt::memory_buffer buffer;
+        write_to(buffer, t);
+        return fmt::to_string(buffer);
+    }
+};
+
+} // namespace stan::lilypond
@@ -11,7 +11,6 @@
 #include <stan/notation/clef.hpp>
 #include <stan/notation/key.hpp>
 
-#include <stan/notation/copy.hpp>
 #include <stan/notation/duration.hpp>
 #include <stan/notation/equal.hpp>
 
@@ -5,6 +5,8 @@
 
 #include <boost/hana/define_struct.hpp>
 
+#include <memory_resource>
+
 namespace stan {
 
 struct invalid_beam : exception
@@ -17,7 +19,14 @@ struct invalid_beam : exception
 
 struct beam
 {
-    BOOST_HANA_DEFINE_STRUCT(beam, (std::vector<column>, m_elements));
+    BOOST_HANA_DEFINE_STRUCT(beam, (std::pmr::vector<column>, m_elements));
+
+    // The elements keep their allocator.
+    beam(std::pmr::vector<column> &&n) :
+        m_elements(std::move(n))
+    {
+        validate();
+    }
 
     template <typename Element>
     beam(const std::vector<Element> &n)
@@ -26,8 +35,9 @@ struct beam
         validate();
     }
 
+    // Explicit, or else anything at all would convert to a beam of itself.
     template <typename... VoiceElement>
-    beam(VoiceElement... element)
+    explicit beam(VoiceElement... element)
     {
         (m_elements.emplace_back(element), ...);
         validate();
@@ -6,6 +6,8 @@
 
 #include <boost/hana/define_struct.hpp>
 
+#include <memory_resource>
+
 namespace stan {
 
 struct invalid_chord : exception
@@ -20,15 +22,17 @@ struct chord
 {
     BOOST_HANA_DEFINE_STRUCT(chord,
                              (value, m_value),
-                             (std::vector<pitch>, m_pitches));
+                             (std::pmr::vector<pitch>, m_pitches));
 
     template <typename Container>
-    chord(const value &v, Container &&n) :
-        m_value(v)
+    chord(const value &v, Container &&n,
+          const std::pmr::polymorphic_allocator<pitch> &alloc = {}) :
+        m_value(v), m_pitches(alloc)
     {
         if (n.size() < 2)
             throw invalid_chord("at least two pitches required");
 
+        m_pitches.reserve(n.size());
         std::move(n.begin(), n.end(), std::back_inserter(m_pitches));
         std::sort(m_pitches.begin(), m_pitches.end());
         m_pitches.erase(std::unique(m_pitches.begin(), m_pitches.end()), m_pitches.end());
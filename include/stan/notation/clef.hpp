@@ -19,7 +19,7 @@ struct clef
                              // (std::int8_t, transpose)
 			     );
 
-    clef(type t) : m_type(t) {}
+    constexpr clef(type t) : m_type(t) {}
     // constexpr clef() :
     //     clef(clef::treble()) {}
 
@@ -5,6 +5,8 @@
 
 #include <boost/hana/define_struct.hpp>
 
+#include <algorithm>
+#include <array>
 #include <vector>
 #include <numeric>
 #include <iostream>
@@ -13,8 +15,44 @@ namespace stan {
   
 namespace mode {
 
-static const std::vector<std::uint8_t> major { 0, 2, 4, 5, 7, 9, 11 };
-static const std::vector<std::uint8_t> minor { 0, 2, 3, 5, 7, 8, 10 };
+// The degrees of the modes as constants, for keys built in constant
+// expressions.
+inline constexpr std::array<std::uint8_t, 7> major_degrees { 0, 2, 4, 5, 7, 9, 11 };
+inline constexpr std::array<std::uint8_t, 7> minor_degrees { 0, 2, 3, 5, 7, 8, 10 };
+
+static const std::vector<std::uint8_t> major (major_degrees.begin(), major_degrees.end());
+static const std::vector<std::uint8_t> minor (minor_degrees.begin(), minor_degrees.end());
+
+// A key is classified and compared by a byte rather than by its degrees.
+// Major and minor have ids of their own, and every other mode shares
+// other_id, so keys in other modes compare their degrees as well.
+using id = std::uint8_t;
+
+inline constexpr id major_id = 0;
+inline constexpr id minor_id = 1;
+inline constexpr id other_id = 2;
+
+constexpr bool same(const std::array<std::uint8_t, 7> &d1,
+                    const std::array<std::uint8_t, 7> &d2)
+{
+    for (std::size_t i = 0; i < d1.size(); ++i) {
+        if (d1[i] != d2[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+constexpr id identify(const std::array<std::uint8_t, 7> &degrees)
+{
+    if (same(degrees, major_degrees)) {
+        return major_id;
+    }
+    if (same(degrees, minor_degrees)) {
+        return minor_id;
+    }
+    return other_id;
+}
 
 }
 
@@ -28,9 +66,15 @@ struct invalid_key : exception
 
 struct key {
 
+    // Only standard 7 pitch modes are supported, so the mode is held in
+    // place, and a key is a literal type.
+    using degrees = std::array<std::uint8_t, 7>;
+
+    // m_mode_id follows from the degrees, which are private so that the two
+    // cannot disagree.
     BOOST_HANA_DEFINE_STRUCT(key,
             (pitchclass, m_tonic),
-            (std::vector<std::uint8_t>, m_mode)
+            (mode::id, m_mode_id)
     );
 
     // Key construction is rare, but every note has to be checked
@@ -40,34 +84,23 @@ struct key {
     // from those, used to accelerate the frequent containment check.
     std::array<bool, 256> m_fastcheck { false };
 
-    bool contains(pitchclass pc) const { 
+    constexpr bool contains(pitchclass pc) const { 
         return m_fastcheck[static_cast<std::uint8_t>(pc)]; 
     }
 
-    bool contains(pitch p) const { 
+    constexpr bool contains(pitch p) const { 
         return m_fastcheck[static_cast<std::uint8_t>(p.m_pitchclass)]; 
     }
 
-    key(pitchclass tonic, std::vector<std::uint8_t> mode) 
-	    : m_tonic(tonic), m_mode(mode)
+    constexpr key(pitchclass tonic, const degrees &mode)
+	    : m_tonic(tonic), m_mode_id(mode::identify(mode)), m_mode(mode)
     {
-	if (mode.size() != 7)
-	{
-	    // Major and minor are probably the only modes ever explicitly
-	    // indicated by a key signature.  Semantics of a "key" object for
-	    // non 7 note modes (like whole tone or diminished scales) are
-	    // really not clear at all, and probably never needed either.  We
-	    // just do not have standard notations for key-like entities for
-	    // anything other than minor or major.
-    	    throw invalid_key("only standard 7 pitch modes are supported");
-	}
-
-	for (std::uint16_t degree = 0; degree < mode.size(); ++degree)
+	for (std::uint16_t degree = 0; degree < m_mode.size(); ++degree)
         {
             std::int16_t pitchcode = 
                 static_cast<std::uint16_t>(tonic) // start with the tonic 
                     + 0x10*degree // add the scale degree
-                    + mode[degree] - 2*degree // add the mode's accidental
+                    + m_mode[degree] - 2*degree // add the mode's accidental
                     ;
 
             // Deal with wrap around from the b range back to c.  The 0x70 term
@@ -83,6 +116,24 @@ struct key {
         }
     }
 
+    key(pitchclass tonic, const std::vector<std::uint8_t> &mode)
+	    : key(tonic, checked(mode))
+    {
+    }
+
+    constexpr bool major() const { return m_mode_id == mode::major_id; }
+    constexpr bool minor() const { return m_mode_id == mode::minor_id; }
+
+    constexpr const degrees &mode_degrees() const { return m_mode; }
+
+    friend constexpr bool operator==(const key &k1, const key &k2)
+    {
+        return k1.m_tonic == k2.m_tonic and k1.m_mode_id == k2.m_mode_id and
+            (k1.m_mode_id != mode::other_id or mode::same(k1.m_mode, k2.m_mode));
+    }
+
+    friend constexpr bool operator!=(const key &k1, const key &k2) { return !(k1 == k2); }
+
     std::vector<pitchclass> scale() const
     {
 	static const valid_pitchclass pitches;
@@ -97,6 +148,27 @@ struct key {
 	}
 	return s;
     }
+
+  private:
+    degrees m_mode;
+
+    static degrees checked(const std::vector<std::uint8_t> &mode)
+    {
+	if (mode.size() != 7)
+	{
+	    // Major and minor are probably the only modes ever explicitly
+	    // indicated by a key signature.  Semantics of a "key" object for
+	    // non 7 note modes (like whole tone or diminished scales) are
+	    // really not clear at all, and probably never needed either.  We
+	    // just do not have standard notations for key-like entities for
+	    // anything other than minor or major.
+    	    throw invalid_key("only standard 7 pitch modes are supported");
+	}
+
+	degrees d {};
+	std::copy(mode.begin(), mode.end(), d.begin());
+	return d;
+    }
 };
 
 } // namespace stan
@@ -4,16 +4,26 @@
 
 #include <boost/hana/define_struct.hpp>
 
+#include <memory_resource>
+
 namespace stan {
 
 struct meter
 {
     BOOST_HANA_DEFINE_STRUCT(meter,
-                             (std::vector<std::uint8_t>, m_beats),
+                             (std::pmr::vector<std::uint8_t>, m_beats),
                              (value, m_value));
 
-    meter(std::vector<std::uint8_t> beats, value v) :
-        m_beats{ beats }, m_value{ v }
+    // The beats keep their allocator.
+    meter(std::pmr::vector<std::uint8_t> beats, value v) :
+        m_beats{ std::move(beats) }, m_value{ v }
+    {
+        validate();
+    }
+
+    template <typename Beats>
+    meter(const Beats &beats, value v) :
+        m_beats(beats.begin(), beats.end()), m_value{ v }
     {
         validate();
     }
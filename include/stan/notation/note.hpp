@@ -13,7 +13,7 @@ struct note
                              (value, m_value),
                              (pitch, m_pitch));
 
-    note(const value &v, const pitch &p) :
+    constexpr note(const value &v, const pitch &p) :
         m_value(v), m_pitch(p) {}
 };
 
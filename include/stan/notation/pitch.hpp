@@ -54,7 +54,7 @@ struct pitch
                              (stan::pitchclass, m_pitchclass),
                              (stan::octave, m_octave));
 
-    pitch(pitchclass p, octave oct) :
+    constexpr pitch(pitchclass p, octave oct) :
         m_pitchclass{ p }, m_octave{ oct } {}
 
     staffline get_staffline() const;
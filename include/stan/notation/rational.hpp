@@ -21,33 +21,34 @@ struct rational
 {
     using integer = T;
 
-    T num() const;
-    T den() const;
+    constexpr T num() const;
+    constexpr T den() const;
 
-    void operator=(const rational &v);
+    constexpr void operator=(const rational &v);
 
     operator float() const;
 
     // Safety violating factory function for use in unit tests.
-    static rational<T> unsafe(T n, T d);
+    static constexpr rational<T> unsafe(T n, T d);
 
     // Construct rational from real number.  Make it a factory function instead
     // of a constructor to avoid implicit conversion from float, and unintended
-    // use.  This factory is rarely used; possibly only by tuplet.
+    // use.  This factory is rarely used.
     static rational<T> quantize(float);
 
   protected:
     // Make it impossible to contain an arbitrary value by allowing only
     // subclasses to construct valid values.
 
-    rational(T n, T d)
+    constexpr rational(T n, T d) :
+        m_num(0), m_den(1)
     {
         integer gcd = compute_gcd(n, d);
         m_num = n / gcd;
         m_den = d / gcd;
     }
 
-    static integer compute_gcd(integer a, integer b);
+    static constexpr integer compute_gcd(integer a, integer b);
 
   private:
     T m_num;
@@ -55,20 +56,20 @@ struct rational
 };
 
 template <typename T>
-T rational<T>::num() const
+constexpr T rational<T>::num() const
 {
     return m_num;
 }
 
 template <typename T>
-T rational<T>::den() const
+constexpr T rational<T>::den() const
 {
     assert(m_den > 0); // Silence clang DivideZero warning
     return m_den;
 }
 
 template <typename T>
-void rational<T>::operator=(rational const &v)
+constexpr void rational<T>::operator=(rational const &v)
 {
     m_num = v.num();
     m_den = v.den();
@@ -81,58 +82,60 @@ rational<T>::operator float() const
 }
 
 template <typename T>
-rational<T> rational<T>::unsafe(T n, T d)
+constexpr rational<T> rational<T>::unsafe(T n, T d)
 {
     return rational<T>(n, d);
 }
 
 template <typename T>
-bool operator<(rational<T> const &v1, rational<T> const &v2)
+constexpr bool operator<(rational<T> const &v1, rational<T> const &v2)
 {
     return v1.num() * v2.den() < v2.num() * v1.den();
 }
 
 template <typename T>
-bool operator>(rational<T> const &v1, rational<T> const &v2)
+constexpr bool operator>(rational<T> const &v1, rational<T> const &v2)
 {
     return v1.num() * v2.den() > v2.num() * v1.den();
 }
 
 template <typename T>
-bool operator>=(rational<T> const &v1, rational<T> const &v2)
+constexpr bool operator>=(rational<T> const &v1, rational<T> const &v2)
 {
     return v1.num() * v2.den() >= v2.num() * v1.den();
 }
 
 template <typename T>
-bool operator<=(rational<T> const &v1, rational<T> const &v2)
+constexpr bool operator<=(rational<T> const &v1, rational<T> const &v2)
 {
     return v1.num() * v2.den() <= v2.num() * v1.den();
 }
 
 template <typename T>
-bool operator==(rational<T> const &v1, rational<T> const &v2)
+constexpr bool operator==(rational<T> const &v1, rational<T> const &v2)
 {
     return v1.num() * v2.den() == v2.num() * v1.den();
 }
 
 template <typename T>
-bool operator!=(rational<T> const &v1, rational<T> const &v2)
+constexpr bool operator!=(rational<T> const &v1, rational<T> const &v2)
 {
     return v1.num() * v2.den() != v2.num() * v1.den();
 }
 
 template <typename T>
-bool operator==(rational<T> const &p1, std::pair<T, T> const &p2)
+constexpr bool operator==(rational<T> const &p1, std::pair<T, T> const &p2)
 {
     return p1.num() == p2.first and p1.den() == p2.second;
 }
 
 template <typename T>
-T rational<T>::compute_gcd(T a, T b)
+constexpr T rational<T>::compute_gcd(T a, T b)
 {
     while (b != 0) {
-        a = std::exchange(b, a % b);
+        T r = a % b;
+        a = b;
+        b = r;
     }
     assert(a > 0); // Silence clang DivideZero warning
     return a;
@@ -10,7 +10,7 @@ struct rest
 {
     BOOST_HANA_DEFINE_STRUCT(rest, (value, m_value));
 
-    rest(const value &v) :
+    constexpr rest(const value &v) :
         m_value(v) {}
 };
 
@@ -5,7 +5,9 @@
 
 #include <boost/hana/define_struct.hpp>
 
+#include <memory_resource>
 #include <numeric>
+#include <optional>
 
 namespace stan {
 
@@ -21,7 +23,19 @@ struct tuplet
 {
     BOOST_HANA_DEFINE_STRUCT(tuplet,
                              (value, m_value),
-                             (std::vector<column>, m_elements));
+                             (std::pmr::vector<column>, m_elements));
+
+    // The elements keep their allocator.
+    tuplet(const value &v, std::pmr::vector<column> &&n) :
+        m_value(v), m_elements(std::move(n))
+    {
+        validate();
+        compute_ratio();
+    }
+
+    // A num/den tuplet, whose value is scaled from its elements, as
+    // LilyPond's \tuplet num/den { ... } is.
+    tuplet(int num, int den, std::pmr::vector<column> &&n);
 
     template <typename Element>
     tuplet(const value &v, const std::vector<Element> &n) :
@@ -29,16 +43,22 @@ struct tuplet
     {
         std::copy(n.begin(), n.end(), std::back_inserter(m_elements));
         validate();
+        compute_ratio();
     }
 
     template <typename... VoiceElement>
-    tuplet(const value &v, VoiceElement... element) :
+    explicit tuplet(const value &v, VoiceElement... element) :
         m_value(v)
     {
         (m_elements.emplace_back(element), ...);
         validate();
+        compute_ratio();
     }
 
+    // The value of a num/den tuplet of elements lasting inner, if there is
+    // one.  scale() is the same, but throws if there is not.
+    static std::optional<value> fit(int num, int den, duration const &inner);
+
     static value scale(int num, int den, duration const &inner);
     static value scale(int num, int den, value const &inner);
 
@@ -47,8 +67,21 @@ struct tuplet
 
     operator duration() const { return m_value; }
 
+    // The ratio written as \tuplet num/den: the duration of the elements over
+    // m_value, in lowest terms, as they were when the tuplet was built.  It
+    // follows from the other members, so it takes no part in comparisons.
+    int num() const { return m_num; }
+    int den() const { return m_den; }
+
   private:
     void validate() const;
+
+    // Sums the durations of the elements, so only the constructors that are
+    // not given the ratio call it.
+    void compute_ratio();
+
+    int m_num = 1;
+    int m_den = 1;
 };
 
 template <typename ElementContainer>
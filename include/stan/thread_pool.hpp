@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace stan {
+
+// A fixed size pool of worker threads, for the drivers that spread work over
+// several cores.  Tasks run in submission order, and each submission returns a
+// std::future, which also carries any exception the task throws.
+
+class thread_pool
+{
+  public:
+    explicit thread_pool(std::size_t threads = std::thread::hardware_concurrency())
+    {
+        threads = std::max<std::size_t>(threads, 1);
+        for (std::size_t i = 0; i < threads; ++i) {
+            m_threads.emplace_back([this] { work(); });
+        }
+    }
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_ready.notify_all();
+        for (auto &t : m_threads) {
+            t.join();
+        }
+    }
+
+    std::size_t size() const { return m_threads.size(); }
+
+    template <typename Function>
+    std::future<std::invoke_result_t<Function>> submit(Function &&f)
+    {
+        // std::function must be copyable, but std::packaged_task is not.
+        auto task = std::make_shared<std::packaged_task<std::invoke_result_t<Function>()>>(
+            std::forward<Function>(f));
+        auto result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.emplace_back([task] { (*task)(); });
+        }
+        m_ready.notify_one();
+        return result;
+    }
+
+  private:
+    void work()
+    {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_ready.wait(lock, [this] { return m_stop or !m_tasks.empty(); });
+                if (m_tasks.empty()) {
+                    return;
+                }
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> m_threads;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_ready;
+    bool m_stop = false;
+};
+
+} // namespace stan
@@ -108,12 +108,12 @@ std::string writer::operator()(key const &k) const
 {
     std::string tonic = pitchclass_names.at(k.m_tonic);
 
-    if (k == key(k.m_tonic, mode::major))
+    if (k.major())
     {
 	return fmt::format(R"({} major)", tonic);
     }
 
-    if (k == key(k.m_tonic, mode::minor))
+    if (k.minor())
     {
 	return fmt::format(R"({} minor)", tonic);
     }
@@ -0,0 +1,81 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include <stan/thread_pool.hpp>
+
+#include <atomic>
+#include <exception>
+#include <future>
+
+namespace stan::lilypond {
+
+namespace {
+
+// Snippets are handed out to the threads this many at a time, which is
+// coarse enough to keep the shared counter cold, and fine enough to balance
+// the load at the end of a batch.
+constexpr std::size_t grain = 64;
+
+} // namespace
+
+batch_reader::batch_reader(thread_pool &pool) :
+    m_pool(pool)
+{
+    for (std::size_t i = 0; i < pool.size(); ++i) {
+        m_readers.emplace_back(arena);
+    }
+}
+
+batch_reader::~batch_reader() = default;
+
+void batch_reader::release()
+{
+    for (auto &read : m_readers) {
+        read.release();
+    }
+}
+
+std::vector<result<column>> batch_reader::operator()(const std::vector<std::string_view> &snippets)
+{
+    std::vector<result<column>> results(snippets.size(), parse_error{});
+    std::atomic<std::size_t> next{ 0 };
+
+    std::vector<std::future<void>> tasks;
+    for (auto &read : m_readers) {
+        tasks.push_back(m_pool.submit([&read, &snippets, &results, &next] {
+            for (;;) {
+                std::size_t first = next.fetch_add(grain, std::memory_order_relaxed);
+                if (first >= snippets.size()) {
+                    return;
+                }
+                std::size_t last = std::min(first + grain, snippets.size());
+                for (std::size_t i = first; i < last; ++i) {
+                    results[i] = read.parse(snippets[i]);
+                }
+            }
+        }));
+    }
+
+    // Every task must be waited for, as each writes to the locals above, and
+    // then the first exception is rethrown.
+    std::exception_ptr error;
+    for (auto &t : tasks) {
+        try {
+            t.get();
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return results;
+}
+
+std::vector<result<column>> batch_reader::operator()(const std::vector<std::string> &snippets)
+{
+    return (*this)(std::vector<std::string_view>(snippets.begin(), snippets.end()));
+}
+
+} // namespace stan::lilypond
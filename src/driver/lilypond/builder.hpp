@@ -0,0 +1,127 @@
+#pragma once
+
+#include <stan/notation.hpp>
+#include <stan/exception.hpp>
+
+#include "scanner.hpp"
+
+#include <boost/range/iterator_range.hpp>
+
+#include <memory_resource>
+#include <vector>
+
+namespace stan::lilypond {
+
+// The builder constructs notation trees bottom up, on behalf of the reader's
+// semantic actions.  Completed columns are pushed onto a stack.  A container
+// (beam or tuplet) marks the stack depth where its elements begin when it
+// opens, and when it closes, its elements are moved off the stack into the
+// container's own vector, which is allocated exactly once at its final size.
+// Every notation object is therefore constructed once, directly in its final
+// std::variant, and never copied.  The stacks themselves are reused, so a
+// warmed up builder allocates only for the notation objects it returns, and
+// those come from the builder's memory resource.
+
+class builder
+{
+  public:
+    explicit builder(std::pmr::memory_resource *resource = std::pmr::get_default_resource()) :
+        m_resource(resource) {}
+
+    // Stack depths, saved before an alternative is attempted so that any
+    // partial results can be discarded if the alternative fails.
+    struct mark
+    {
+        std::size_t m_columns;
+        std::size_t m_frames;
+        std::size_t m_pitches;
+    };
+
+    mark position() const
+    {
+        return { m_columns.size(), m_frames.size(), m_pitches.size() };
+    }
+
+    void rewind(const mark &m)
+    {
+        m_columns.erase(m_columns.begin() + m.m_columns, m_columns.end());
+        m_frames.resize(m.m_frames);
+        m_pitches.erase(m_pitches.begin() + m.m_pitches, m_pitches.end());
+    }
+
+    void clear()
+    {
+        m_columns.clear();
+        m_frames.clear();
+        m_pitches.clear();
+    }
+
+    template <typename T, typename... Args>
+    void emplace(Args &&... args)
+    {
+        m_columns.emplace_back(std::in_place_type<T>, std::forward<Args>(args)...);
+    }
+
+    // Chords cannot nest, so every pending pitch belongs to the chord
+    // currently being parsed.
+    void add_pitch(const pitch &p) { m_pitches.push_back(p); }
+
+    void close_chord(const value &v)
+    {
+        emplace<chord>(v, boost::make_iterator_range(m_pitches), m_resource);
+        m_pitches.clear();
+    }
+
+    void open()
+    {
+        if (m_frames.size() == max_depth) {
+            throw exception("beams and tuplets nest deeper than {} levels", max_depth);
+        }
+        m_frames.push_back(m_columns.size());
+    }
+
+    void close_beam() { emplace<beam>(elements()); }
+
+    void close_tuplet(int num, int den)
+    {
+        emplace<tuplet>(num, den, elements());
+    }
+
+    void emplace_meter(std::uint8_t beats, const value &v)
+    {
+        emplace<meter>(std::pmr::vector<std::uint8_t>({ beats }, m_resource), v);
+    }
+
+    void emplace_key(pitchclass tonic, const std::vector<std::uint8_t> &mode)
+    {
+        emplace<key>(tonic, mode);
+    }
+
+    column pop()
+    {
+        column c = std::move(m_columns.back());
+        m_columns.pop_back();
+        return c;
+    }
+
+  private:
+    // Move the innermost container's elements off the stack.
+    std::pmr::vector<column> elements()
+    {
+        auto first = m_columns.begin() + m_frames.back();
+        m_frames.pop_back();
+
+        std::pmr::vector<column> e(m_resource);
+        e.reserve(m_columns.end() - first);
+        std::move(first, m_columns.end(), std::back_inserter(e));
+        m_columns.erase(first, m_columns.end());
+        return e;
+    }
+
+    std::pmr::memory_resource *m_resource;
+    std::vector<column> m_columns;
+    std::vector<std::size_t> m_frames;
+    std::vector<pitch> m_pitches;
+};
+
+} // namespace stan::lilypond
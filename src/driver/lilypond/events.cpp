@@ -0,0 +1,286 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+
+#include "predictive.hpp"
+#include "validating_sink.hpp"
+
+#include <charconv>
+#include <numeric>
+#include <stdexcept>
+
+namespace stan::lilypond {
+
+namespace {
+
+// Turns what the predictive parser recognizes into events as it goes.  Every
+// construct is also checked by a validating sink, and the first one that
+// breaks a rule of the notation model throws what the model would, instead of
+// being sent.
+struct event_sink
+{
+    void rest(const value &v)
+    {
+        m_rules.rest(v);
+        check_duration();
+        m_handler.on_rest(stan::rest{ v });
+    }
+
+    void note(const value &v, const pitch &p)
+    {
+        m_rules.note(v, p);
+        check_duration();
+        m_handler.on_note(stan::note{ v, p });
+    }
+
+    void add_pitch(const pitch &p) { m_pitches.push_back(p); }
+
+    // The same checks and order as the chord constructor.
+    void close_chord(const value &v)
+    {
+        if (m_pitches.size() < 2) {
+            throw invalid_chord("at least two pitches required");
+        }
+        std::sort(m_pitches.begin(), m_pitches.end());
+        if (std::adjacent_find(m_pitches.begin(), m_pitches.end()) != m_pitches.end()) {
+            throw invalid_chord("unique pitches required");
+        }
+        for (const pitch &p : m_pitches) {
+            m_rules.add_pitch(p);
+        }
+        m_rules.close_chord(v);
+        check_duration();
+        m_handler.on_chord(v, { m_pitches.data(), m_pitches.size() });
+        m_pitches.clear();
+    }
+
+    void open_beam()
+    {
+        m_rules.open_beam();
+        m_handler.begin_beam();
+    }
+
+    void close_beam()
+    {
+        m_rules.close_beam();
+        if (!m_rules.valid()) {
+            throw invalid_beam("cannot contain rests, changes, or whole or half notes, "
+                               "and must contain at least two elements");
+        }
+        m_handler.end_beam();
+    }
+
+    void open_tuplet(int num, int den)
+    {
+        m_rules.open_tuplet(num, den);
+        m_handler.begin_tuplet(num, den);
+    }
+
+    void close_tuplet(int num, int den)
+    {
+        m_rules.close_tuplet(num, den);
+        if (!m_rules.valid()) {
+            throw invalid_tuplet("ratio {}/{} must scale at least two elements to a valid value",
+                                 num, den);
+        }
+        m_handler.end_tuplet();
+    }
+
+    void meter(std::uint8_t beats, const value &v)
+    {
+        m_rules.meter(beats, v);
+        if (!m_rules.valid()) {
+            throw invalid_meter(
+                "value must be half, quarter, eighth, sixteenth, or thirtysecond");
+        }
+        m_handler.on_meter(beats, v);
+    }
+
+    void clef(clef::type t)
+    {
+        m_rules.clef(t);
+        m_handler.on_clef(stan::clef{ t });
+    }
+
+    // The parser only knows major and minor.
+    void key(pitchclass tonic, const std::vector<std::uint8_t> &degrees)
+    {
+        m_rules.key(tonic, degrees);
+        m_handler.on_key(tonic, degrees == mode::major ? mode::major_id : mode::minor_id);
+    }
+
+    // A value without a duration only breaks a rule inside a tuplet, where
+    // the model has to add it up.
+    void check_duration()
+    {
+        if (!m_rules.valid()) {
+            throw std::out_of_range("value has no duration");
+        }
+    }
+
+    event_handler &m_handler;
+    std::vector<pitch> &m_pitches;
+    validating_sink &m_rules;
+};
+
+template <typename Integer>
+void append_integer(std::string &lily, Integer n)
+{
+    char digits[16];
+    lily.append(digits, std::to_chars(std::begin(digits), std::end(digits), n).ptr);
+}
+
+void append(std::string &lily, const value &v)
+{
+    if (v == value::instantaneous()) {
+        return;
+    }
+    append_integer(lily, v.den() / (1u << v.dots()));
+    lily.append(v.dots(), '.');
+}
+
+void append(std::string &lily, const pitch &p)
+{
+    lily += pitchclass_names.at(p.m_pitchclass);
+    int ticks = static_cast<std::uint8_t>(p.m_octave) - 4;
+    lily.append(std::max(ticks, 0), '\'');
+    lily.append(std::max(-ticks, 0), ',');
+}
+
+} // namespace
+
+void event_reader::operator()(std::string_view lily, event_handler &handler)
+{
+    m_pitches.clear();
+    validating_sink rules;
+    event_sink sink{ handler, m_pitches, rules };
+    predictive_parser<event_sink> p(lily, sink);
+
+    p.skip();
+    while (!p.done()) {
+        if (!p.column()) {
+            throw std::runtime_error("parse error");
+        }
+        p.skip();
+    }
+}
+
+void event_writer::separate()
+{
+    if (!m_first) {
+        m_lily += ' ';
+    }
+    m_first = false;
+}
+
+void event_writer::on_rest(const rest &r)
+{
+    separate();
+    m_lily += 'r';
+    append(m_lily, r.m_value);
+}
+
+void event_writer::on_note(const note &n)
+{
+    separate();
+    append(m_lily, n.m_pitch);
+    append(m_lily, n.m_value);
+}
+
+void event_writer::on_chord(const value &v, pitch_span pitches)
+{
+    separate();
+    m_lily += '<';
+    for (const pitch &p : pitches) {
+        append(m_lily, p);
+        m_lily += ' ';
+    }
+    m_lily.back() = '>';
+    append(m_lily, v);
+}
+
+void event_writer::begin_beam()
+{
+    separate();
+    m_lily += '[';
+    m_first = true;
+}
+
+void event_writer::end_beam()
+{
+    m_lily += ']';
+    m_first = false;
+}
+
+void event_writer::begin_tuplet(int num, int den)
+{
+    if (int gcd = std::gcd(num, den); gcd > 1) {
+        num /= gcd;
+        den /= gcd;
+    }
+
+    separate();
+    m_lily += R"(\tuplet )";
+    append_integer(m_lily, num);
+    m_lily += '/';
+    append_integer(m_lily, den);
+    m_lily += " {";
+    m_first = true;
+}
+
+void event_writer::end_tuplet()
+{
+    m_lily += '}';
+    m_first = false;
+}
+
+void event_writer::on_meter(std::uint8_t beats, const value &v)
+{
+    separate();
+    m_lily += R"(\time )";
+    append_integer(m_lily, unsigned{ beats });
+    m_lily += '/';
+    append_integer(m_lily, v.den());
+}
+
+void event_writer::on_clef(const clef &c)
+{
+    separate();
+    m_lily += R"(\clef )";
+    switch (c.m_type) {
+    case clef::type::treble:
+        m_lily += "treble";
+        break;
+    case clef::type::alto:
+        m_lily += "alto";
+        break;
+    case clef::type::tenor:
+        m_lily += "tenor";
+        break;
+    case clef::type::bass:
+        m_lily += "bass";
+        break;
+    case clef::type::percussion:
+        m_lily += "percussion";
+        break;
+    }
+}
+
+void event_writer::on_key(pitchclass tonic, mode::id id)
+{
+    const char *name = nullptr;
+    if (id == mode::major_id) {
+        name = R"(\major)";
+    } else if (id == mode::minor_id) {
+        name = R"(\minor)";
+    } else {
+        throw invalid_key("key is neither major nor minor");
+    }
+
+    separate();
+    m_lily += R"(\key )";
+    m_lily += pitchclass_names.at(tonic);
+    m_lily += ' ';
+    m_lily += name;
+}
+
+} // namespace stan::lilypond
@@ -0,0 +1,232 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include <stan/exception.hpp>
+#include <stan/thread_pool.hpp>
+
+#include "scanner.hpp"
+
+#include <filesystem>
+#include <future>
+#include <set>
+
+namespace stan::lilypond {
+
+namespace fs = std::filesystem;
+
+struct include_reader::file
+{
+    fs::file_time_type m_time;
+    std::uintmax_t m_size;
+    std::size_t m_hash;
+
+    std::shared_ptr<const std::vector<column>> m_columns;
+
+    // The columns of the file at m_path go before m_columns[m_position].
+    struct include
+    {
+        std::size_t m_position;
+        std::string m_path;
+    };
+    std::vector<include> m_includes;
+};
+
+namespace {
+
+struct stamp
+{
+    fs::file_time_type m_time;
+    std::uintmax_t m_size;
+};
+
+stamp stat(const std::string &path)
+{
+    std::error_code error;
+    fs::file_time_type time = fs::last_write_time(path, error);
+    std::uintmax_t size = error ? 0 : fs::file_size(path, error);
+    if (error) {
+        throw exception("cannot stat {}: {}", path, error.message());
+    }
+    return { time, size };
+}
+
+// Split the text of a file at each top level \include "path", parsing the
+// columns in between.
+void parse(std::string_view lily, const fs::path &directory, include_reader::file &f)
+{
+    static constexpr std::string_view command = R"(\include)";
+
+    reader read;
+    auto columns = std::make_shared<std::vector<column>>();
+
+    std::size_t start = 0;
+    int depth = 0;
+    for (std::size_t i = 0; i < lily.size(); ++i) {
+        char c = lily[i];
+        if (c == '[' or c == '{' or c == '<') {
+            ++depth;
+        } else if (c == ']' or c == '}' or c == '>') {
+            --depth;
+        } else if (c == '\\' and depth == 0 and (i == 0 or is_space(lily[i - 1])) and
+                   lily.substr(i, command.size()) == command) {
+            read.append(lily.substr(start, i - start), *columns);
+
+            std::size_t open = i + command.size();
+            while (open < lily.size() and is_space(lily[open])) {
+                ++open;
+            }
+            std::size_t close = lily.find('"', open + 1);
+            if (open == i + command.size() or open >= lily.size() or lily[open] != '"' or
+                close == std::string_view::npos) {
+                throw std::runtime_error("parse error");
+            }
+
+            fs::path included = directory / lily.substr(open + 1, close - open - 1);
+            f.m_includes.push_back({ columns->size(), fs::weakly_canonical(included).string() });
+            start = close + 1;
+            i = close;
+        }
+    }
+    read.append(lily.substr(start), *columns);
+
+    f.m_columns = std::move(columns);
+}
+
+// Read the file at path, unless it hashes the same as the cached copy, in
+// which case an empty optional is returned.  The file at the root of the
+// include graph holds the sequence; the others hold the columns only.
+std::optional<include_reader::file> load(const std::string &path, stamp s, bool root,
+                                         std::optional<std::size_t> cached_hash)
+{
+    mapped_file mapping(path);
+    std::string_view lily = mapping.view();
+
+    std::size_t hash = std::hash<std::string_view>()(lily);
+    if (cached_hash == hash) {
+        return std::nullopt;
+    }
+
+    if (root) {
+        std::optional<std::string_view> body = sequence_body(lily);
+        if (!body) {
+            throw std::runtime_error("parse error");
+        }
+        lily = *body;
+    }
+
+    include_reader::file f{ s.m_time, s.m_size, hash, nullptr, {} };
+    parse(lily, fs::path(path).parent_path(), f);
+    return f;
+}
+
+} // namespace
+
+include_reader::include_reader(thread_pool &pool) :
+    m_pool(pool)
+{
+}
+
+include_reader::~include_reader() = default;
+
+std::vector<include_reader::run> include_reader::operator()(const std::string &path)
+{
+    std::string root = fs::weakly_canonical(path).string();
+    m_parsed = 0;
+
+    // Bring the cache up to date one level of the include graph at a time.
+    // Only the files on a level are known when the level begins, but every
+    // one of them can be read at once.
+    std::set<std::string> seen{ root };
+    std::vector<std::string> level{ root };
+    while (!level.empty()) {
+        struct pending
+        {
+            file *m_file;
+            stamp m_stamp;
+            std::future<std::optional<file>> m_load;
+        };
+        std::vector<pending> loads;
+        for (const std::string &p : level) {
+            stamp s = stat(p);
+            auto &cached = m_files[p];
+            if (cached and cached->m_time == s.m_time and cached->m_size == s.m_size) {
+                continue;
+            }
+
+            std::optional<std::size_t> hash;
+            if (cached) {
+                hash = cached->m_hash;
+            } else {
+                cached = std::make_unique<file>();
+            }
+            loads.push_back({ cached.get(), s, m_pool.submit([p, s, hash, is_root = p == root] {
+                                 return load(p, s, is_root, hash);
+                             }) });
+        }
+
+        // Keep every file that did load before throwing for one that did not.
+        std::exception_ptr error;
+        for (auto &l : loads) {
+            try {
+                if (std::optional<file> f = l.m_load.get()) {
+                    *l.m_file = std::move(*f);
+                    ++m_parsed;
+                } else {
+                    l.m_file->m_time = l.m_stamp.m_time;
+                    l.m_file->m_size = l.m_stamp.m_size;
+                }
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+        if (error) {
+            for (auto it = m_files.begin(); it != m_files.end();) {
+                it = it->second->m_columns ? std::next(it) : m_files.erase(it);
+            }
+            std::rethrow_exception(error);
+        }
+
+        std::vector<std::string> next;
+        for (const std::string &p : level) {
+            for (const auto &i : m_files[p]->m_includes) {
+                if (seen.insert(i.m_path).second) {
+                    next.push_back(i.m_path);
+                }
+            }
+        }
+        level = std::move(next);
+    }
+
+    std::vector<std::string> stack;
+    return flatten(root, stack);
+}
+
+std::vector<include_reader::run> include_reader::flatten(const std::string &path,
+                                                         std::vector<std::string> &stack) const
+{
+    if (std::find(stack.begin(), stack.end(), path) != stack.end()) {
+        throw exception("{} includes itself", path);
+    }
+    stack.push_back(path);
+
+    const file &f = *m_files.at(path);
+    std::vector<run> runs;
+    std::size_t first = 0;
+    auto add = [&runs, &f](std::size_t first, std::size_t last) {
+        if (first != last) {
+            runs.push_back({ f.m_columns, first, last });
+        }
+    };
+
+    for (const auto &i : f.m_includes) {
+        add(first, i.m_position);
+        first = i.m_position;
+        std::vector<run> included = flatten(i.m_path, stack);
+        runs.insert(runs.end(), included.begin(), included.end());
+    }
+    add(first, f.m_columns->size());
+
+    stack.pop_back();
+    return runs;
+}
+
+} // namespace stan::lilypond
@@ -0,0 +1,540 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+
+#include "builder.hpp"
+#include "recover.hpp"
+#include "scanner.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+
+namespace stan::lilypond {
+
+namespace {
+
+// Blocks are split when a splice leaves them larger than this.
+constexpr std::size_t block_size = 128;
+
+// Replace v[i, j) with the elements of with, moving as little as possible.
+template <typename T>
+void replace(std::vector<T> &v, std::size_t i, std::size_t j, std::vector<T> &&with)
+{
+    std::size_t common = std::min(j - i, with.size());
+    std::move(with.begin(), with.begin() + common, v.begin() + i);
+    if (common < with.size()) {
+        v.insert(v.begin() + i + common, std::make_move_iterator(with.begin() + common),
+                 std::make_move_iterator(with.end()));
+    } else {
+        v.erase(v.begin() + i + common, v.begin() + j);
+    }
+}
+
+// Fenwick trees over a sequence of counts, stored from tree[1], so that
+// tree[i] holds the sum of the counts (i - (i & -i), i].  Sums are unsigned
+// and wrap, so a count can be lowered by adding its two's complement.
+
+namespace fenwick {
+
+void build(std::vector<std::size_t> &tree, const std::vector<std::size_t> &counts)
+{
+    tree.assign(counts.size() + 1, 0);
+    for (std::size_t i = 1; i < tree.size(); ++i) {
+        tree[i] += counts[i - 1];
+        std::size_t parent = i + (i & -i);
+        if (parent < tree.size()) {
+            tree[parent] += tree[i];
+        }
+    }
+}
+
+void add(std::vector<std::size_t> &tree, std::size_t i, std::size_t delta)
+{
+    for (++i; i < tree.size(); i += i & -i) {
+        tree[i] += delta;
+    }
+}
+
+// The sum of the first n counts.
+std::size_t prefix(const std::vector<std::size_t> &tree, std::size_t n)
+{
+    std::size_t sum = 0;
+    for (; n > 0; n -= n & -n) {
+        sum += tree[n];
+    }
+    return sum;
+}
+
+// The most counts from the front whose sum is at most sum.
+std::size_t count(const std::vector<std::size_t> &tree, std::size_t sum)
+{
+    std::size_t n = 0;
+    std::size_t step = 1;
+    while (step * 2 < tree.size()) {
+        step *= 2;
+    }
+    for (; step > 0; step /= 2) {
+        if (n + step < tree.size() and tree[n + step] <= sum) {
+            n += step;
+            sum -= tree[n];
+        }
+    }
+    return n;
+}
+
+} // namespace fenwick
+
+} // namespace
+
+// A run of consecutive items.  Extents and error offsets are relative to the
+// start of the block, which is the start of its first item, or 0 for the first
+// block, and m_span runs from there to the start of the next block, or to the
+// end of the text.  The spans and the unmatched brackets of the items are
+// mirrored in the Fenwick trees.  Blocks are never empty.
+struct incremental_reader::block
+{
+    std::vector<result<column>> m_items;
+    std::vector<extent> m_extents;
+    std::size_t m_span;
+    std::size_t m_closing;
+    std::size_t m_opening;
+};
+
+// An item, by block and index within the block.  The position after the last
+// item is { m_blocks.size(), 0 }.
+struct incremental_reader::position
+{
+    std::size_t m_block;
+    std::size_t m_item;
+
+    friend bool operator<(const position &p1, const position &p2)
+    {
+        return std::tie(p1.m_block, p1.m_item) < std::tie(p2.m_block, p2.m_item);
+    }
+};
+
+incremental_reader::incremental_reader(std::string lily) :
+    m_text(std::move(lily)), m_builder(std::make_unique<builder>())
+{
+    index();
+    splice(0, m_text.size(), { 0, 0 }, { 0, 0 }, 0);
+}
+
+incremental_reader::incremental_reader(incremental_reader &&) noexcept = default;
+incremental_reader &incremental_reader::operator=(incremental_reader &&) noexcept = default;
+incremental_reader::~incremental_reader() = default;
+
+void incremental_reader::edit(std::size_t offset, std::size_t length, std::string_view text)
+{
+    if (offset > m_text.size() or length > m_text.size() - offset) {
+        throw std::out_of_range("edit is outside the buffer");
+    }
+
+    // The items that touch the edit, and their neighbours, because a column
+    // can continue across whitespace: "c4" followed by an inserted " ." is
+    // "c4.".
+    position from = first_ending_from(offset);
+    position to = first_beginning_after(offset + length);
+    if (from.m_block > 0 or from.m_item > 0) {
+        previous(from);
+    }
+    if (to.m_block < m_blocks.size()) {
+        next(to);
+    }
+
+    std::size_t first = offset;
+    std::size_t last = offset + length;
+    if (from < to) {
+        position back = to;
+        previous(back);
+        first = std::min(first, absolute(from).m_first);
+        last = std::max(last, absolute(back).m_last);
+    }
+
+    m_text.replace(offset, length, text);
+
+    // Unsigned arithmetic wraps, so this also works when the edit shrinks
+    // the buffer.
+    std::size_t delta = text.size() - length;
+    last += delta;
+
+    // Past the last item, the parse runs to the end of the buffer, since the
+    // edit may have left text there that no old item covered.
+    if (to.m_block == m_blocks.size()) {
+        last = m_text.size();
+    }
+
+    // Every matched pair of brackets lies within one item, so the brackets
+    // that the new text leaves unmatched can only pair with unmatched ones
+    // outside it: its closing brackets with the nearest opening brackets
+    // before it, and its opening brackets with the first closing brackets
+    // after it.  The items that hold those, and everything they enclose, are
+    // parsed again too.
+    unmatched_count count = count_unmatched(std::string_view(m_text).substr(first, last - first));
+    if (count.m_closing > 0) {
+        if (std::optional<position> p = opening_before(from, count.m_closing)) {
+            from = *p;
+            if (from.m_block > 0 or from.m_item > 0) {
+                previous(from);
+            }
+            first = absolute(from).m_first;
+        }
+    }
+    if (count.m_opening > 0) {
+        if (std::optional<position> p = closing_after(to, count.m_opening, delta)) {
+            to = *p;
+            next(to);
+            if (to.m_block < m_blocks.size()) {
+                next(to);
+            }
+            position back = to;
+            previous(back);
+            last = to.m_block == m_blocks.size() ? m_text.size()
+                                                   : absolute(back).m_last + delta;
+        }
+    }
+
+    splice(first, last, from, to, delta);
+}
+
+void incremental_reader::splice(std::size_t first, std::size_t last, position from,
+                                position to, std::size_t delta)
+{
+    std::vector<result<column>> items;
+    std::vector<extent> extents;
+
+    // Move the items of a block, from the ith on, into items, with their
+    // offsets made absolute.
+    auto take = [&](std::size_t k, std::size_t i, std::size_t j, std::size_t base) {
+        block &b = m_blocks[k];
+        for (; i < j; ++i) {
+            if (!b.m_items[i]) {
+                b.m_items[i].error().m_offset += base;
+            }
+            items.push_back(std::move(b.m_items[i]));
+            extents.push_back({ base + b.m_extents[i].m_first, base + b.m_extents[i].m_last });
+        }
+    };
+
+    // Whatever is left of the first block, before the splice.
+    if (from.m_block < m_blocks.size()) {
+        take(from.m_block, 0, from.m_item, start(from.m_block));
+    }
+
+    std::size_t head = items.size();
+    for (;;) {
+        items.erase(items.begin() + head, items.end());
+        extents.erase(extents.begin() + head, extents.end());
+        recover_columns(std::string_view(m_text).substr(first, last - first), *m_builder,
+                        [&](std::size_t f, std::size_t l, result<column> &&r) {
+                            if (!r) {
+                                r.error().m_offset += first;
+                            }
+                            items.push_back(std::move(r));
+                            extents.push_back({ first + f, first + l });
+                        });
+
+        // Recovery from an error skips ahead to the next column boundary,
+        // which may lie beyond last; the token after \key or \clef is never
+        // a boundary, for instance.  Then the next item must be parsed again
+        // too.
+        if (to.m_block == m_blocks.size() or items.size() == head or items.back() or
+            extents.back().m_last != last) {
+            break;
+        }
+        last = absolute(to).m_last + delta;
+        next(to);
+        if (to.m_block == m_blocks.size()) {
+            last = m_text.size();
+        }
+    }
+
+    // Whatever is left of the last block, after the splice.  The first block
+    // starts at 0 rather than at its first item, so if the splice leaves
+    // nothing before the block after it, that block is cut again too.
+    std::size_t end = to.m_block;
+    if (to.m_block < m_blocks.size()) {
+        take(end, to.m_item, m_blocks[end].m_items.size(), start(end) + delta);
+        ++end;
+    }
+    if (items.empty() and end < m_blocks.size()) {
+        take(end, 0, m_blocks[end].m_items.size(), start(end) + delta);
+        ++end;
+    }
+    std::size_t after = end < m_blocks.size() ? start(end) + delta : m_text.size();
+
+    // Cut the items into evenly sized blocks.  As long as they stay within
+    // reason, there are as many as there were, so that the Fenwick trees
+    // only need updating rather than rebuilding.
+    std::size_t replaced = end - from.m_block;
+    std::size_t count = (items.size() + block_size - 1) / block_size;
+    if (replaced > 0 and items.size() * 4 >= replaced * block_size and
+        items.size() <= replaced * 2 * block_size) {
+        count = replaced;
+    }
+
+    std::vector<block> blocks(count);
+    for (std::size_t i = 0, k = 0; k < count; ++k) {
+        std::size_t j = items.size() * (k + 1) / count;
+        std::size_t base = from.m_block + k == 0 ? 0 : extents[i].m_first;
+        std::size_t next = j < items.size() ? extents[j].m_first : after;
+        block &b = blocks[k];
+        b.m_span = next - base;
+        b.m_closing = 0;
+        b.m_opening = 0;
+        for (; i < j; ++i) {
+            unmatched_count brackets = count_unmatched(std::string_view(m_text).substr(
+                extents[i].m_first, extents[i].m_last - extents[i].m_first));
+            b.m_closing += brackets.m_closing;
+            b.m_opening += brackets.m_opening;
+            if (!items[i]) {
+                items[i].error().m_offset -= base;
+            }
+            b.m_items.push_back(std::move(items[i]));
+            b.m_extents.push_back({ extents[i].m_first - base, extents[i].m_last - base });
+        }
+    }
+
+    // The block before the splice now runs up to the first new one.
+    std::size_t span = 0;
+    if (from.m_block > 0) {
+        span = (count > 0 ? extents.front().m_first : after) - start(from.m_block - 1);
+    }
+
+    if (count == replaced) {
+        if (from.m_block > 0) {
+            block &b = m_blocks[from.m_block - 1];
+            fenwick::add(m_spans, from.m_block - 1, span - b.m_span);
+            b.m_span = span;
+        }
+        for (std::size_t k = 0; k < count; ++k) {
+            block &b = m_blocks[from.m_block + k];
+            fenwick::add(m_spans, from.m_block + k, blocks[k].m_span - b.m_span);
+            fenwick::add(m_closing, from.m_block + k, blocks[k].m_closing - b.m_closing);
+            fenwick::add(m_opening, from.m_block + k, blocks[k].m_opening - b.m_opening);
+            b = std::move(blocks[k]);
+        }
+    } else {
+        replace(m_blocks, from.m_block, end, std::move(blocks));
+        if (from.m_block > 0) {
+            m_blocks[from.m_block - 1].m_span = span;
+        }
+        index();
+    }
+}
+
+void incremental_reader::index()
+{
+    std::vector<std::size_t> spans;
+    std::vector<std::size_t> closing;
+    std::vector<std::size_t> opening;
+    for (const auto &b : m_blocks) {
+        spans.push_back(b.m_span);
+        closing.push_back(b.m_closing);
+        opening.push_back(b.m_opening);
+    }
+    fenwick::build(m_spans, spans);
+    fenwick::build(m_closing, closing);
+    fenwick::build(m_opening, opening);
+}
+
+std::optional<incremental_reader::position>
+incremental_reader::opening_before(position p, std::size_t n) const
+{
+    auto opening = [this](std::size_t k, std::size_t i) {
+        extent e = absolute({ k, i });
+        return count_unmatched(std::string_view(m_text).substr(e.m_first, e.m_last - e.m_first))
+            .m_opening;
+    };
+
+    // Those in the same block as p first.
+    std::optional<position> found;
+    for (std::size_t i = p.m_item; i-- > 0;) {
+        if (std::size_t k = opening(p.m_block, i)) {
+            found = position{ p.m_block, i };
+            if (k >= n) {
+                return found;
+            }
+            n -= k;
+        }
+    }
+
+    // Then the blocks before it, which count their own.
+    std::size_t before = fenwick::prefix(m_opening, p.m_block);
+    if (before == 0) {
+        return found;
+    }
+    std::size_t nth = before - std::min(n, before);
+    std::size_t k = fenwick::count(m_opening, nth);
+    nth -= fenwick::prefix(m_opening, k);
+    for (std::size_t i = 0;; ++i) {
+        std::size_t count = opening(k, i);
+        if (nth < count) {
+            return position{ k, i };
+        }
+        nth -= count;
+    }
+}
+
+std::optional<incremental_reader::position>
+incremental_reader::closing_after(position p, std::size_t n, std::size_t delta) const
+{
+    if (p.m_block == m_blocks.size()) {
+        return std::nullopt;
+    }
+
+    auto closing = [this, delta](std::size_t k, std::size_t i) {
+        extent e = absolute({ k, i });
+        return count_unmatched(
+                   std::string_view(m_text).substr(e.m_first + delta, e.m_last - e.m_first))
+            .m_closing;
+    };
+
+    // Those in the same block as p first.
+    std::optional<position> found;
+    for (std::size_t i = p.m_item; i < m_blocks[p.m_block].m_items.size(); ++i) {
+        if (std::size_t k = closing(p.m_block, i)) {
+            found = position{ p.m_block, i };
+            if (k >= n) {
+                return found;
+            }
+            n -= k;
+        }
+    }
+
+    // Then the blocks after it, which count their own.
+    std::size_t before = fenwick::prefix(m_closing, p.m_block + 1);
+    std::size_t after = fenwick::prefix(m_closing, m_blocks.size()) - before;
+    if (after == 0) {
+        return found;
+    }
+    std::size_t nth = before + std::min(n, after) - 1;
+    std::size_t k = fenwick::count(m_closing, nth);
+    nth -= fenwick::prefix(m_closing, k);
+    for (std::size_t i = 0;; ++i) {
+        std::size_t count = closing(k, i);
+        if (nth < count) {
+            return position{ k, i };
+        }
+        nth -= count;
+    }
+}
+
+std::size_t incremental_reader::start(std::size_t block) const
+{
+    return fenwick::prefix(m_spans, block);
+}
+
+// The block whose bytes, from its start up to the next block's, hold the one
+// at offset; the last block if offset is at or past the end of the text.
+std::size_t incremental_reader::block_at(std::size_t offset) const
+{
+    return std::min(fenwick::count(m_spans, offset), m_blocks.size() - 1);
+}
+
+incremental_reader::position incremental_reader::first_ending_from(std::size_t offset) const
+{
+    if (m_blocks.empty()) {
+        return { 0, 0 };
+    }
+
+    // Items end no later than the start of the next block, so only the block
+    // that holds the byte before offset can hold one that ends at offset.
+    std::size_t k = block_at(std::max<std::size_t>(offset, 1) - 1);
+    const block &b = m_blocks[k];
+    auto e = std::lower_bound(b.m_extents.begin(), b.m_extents.end(), offset - start(k),
+                              [](const extent &e, std::size_t offset) {
+                                  return e.m_last < offset;
+                              });
+    if (e == b.m_extents.end()) {
+        return { k + 1, 0 };
+    }
+    return { k, static_cast<std::size_t>(e - b.m_extents.begin()) };
+}
+
+incremental_reader::position incremental_reader::first_beginning_after(std::size_t offset) const
+{
+    if (m_blocks.empty()) {
+        return { 0, 0 };
+    }
+
+    std::size_t k = block_at(offset);
+    const block &b = m_blocks[k];
+    auto e = std::upper_bound(b.m_extents.begin(), b.m_extents.end(), offset - start(k),
+                              [](std::size_t offset, const extent &e) {
+                                  return offset < e.m_first;
+                              });
+    if (e == b.m_extents.end()) {
+        return { k + 1, 0 };
+    }
+    return { k, static_cast<std::size_t>(e - b.m_extents.begin()) };
+}
+
+incremental_reader::extent incremental_reader::absolute(const position &p) const
+{
+    std::size_t base = start(p.m_block);
+    const extent &e = m_blocks[p.m_block].m_extents[p.m_item];
+    return { base + e.m_first, base + e.m_last };
+}
+
+void incremental_reader::next(position &p) const
+{
+    if (++p.m_item == m_blocks[p.m_block].m_items.size()) {
+        p = { p.m_block + 1, 0 };
+    }
+}
+
+void incremental_reader::previous(position &p) const
+{
+    if (p.m_item > 0) {
+        --p.m_item;
+    } else {
+        --p.m_block;
+        p.m_item = m_blocks[p.m_block].m_items.size() - 1;
+    }
+}
+
+std::vector<column> incremental_reader::music() const
+{
+    std::vector<column> music;
+    for (const auto &b : m_blocks) {
+        for (const auto &item : b.m_items) {
+            if (item) {
+                music.push_back(*item);
+            }
+        }
+    }
+    return music;
+}
+
+std::vector<parse_error> incremental_reader::errors() const
+{
+    std::vector<parse_error> errors;
+    std::size_t base = 0;
+    for (const auto &b : m_blocks) {
+        for (const auto &item : b.m_items) {
+            if (!item) {
+                errors.push_back(item.error());
+                errors.back().m_offset += base;
+            }
+        }
+        base += b.m_span;
+    }
+    return errors;
+}
+
+std::vector<incremental_reader::extent> incremental_reader::extents() const
+{
+    std::vector<extent> extents;
+    std::size_t base = 0;
+    for (const auto &b : m_blocks) {
+        for (const auto &e : b.m_extents) {
+            extents.push_back({ base + e.m_first, base + e.m_last });
+        }
+        base += b.m_span;
+    }
+    return extents;
+}
+
+} // namespace stan::lilypond
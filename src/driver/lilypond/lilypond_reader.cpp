@@ -1,14 +1,20 @@
 #include <stan/notation.hpp>
-#include <stan/notation/copy.hpp>
 
 #include <stan/driver/lilypond.hpp>
 #include <stan/driver/debug.hpp>
 
+#include "builder.hpp"
+#include "recover.hpp"
+#include "scanner.hpp"
+
 // #define BOOST_SPIRIT_X3_DEBUG
 #include <boost/spirit/home/x3.hpp>
+#include <boost/spirit/include/support_multi_pass.hpp>
 
+#include <algorithm>
 #include <fstream>
 #include <memory>
+#include <memory_resource>
 #include <numeric>
 #include <iostream>
 
@@ -24,6 +30,10 @@ namespace stan {
 // So default_ctor<T> is just a class T with a default constructor defined.
 // Specializations of default_value<T> follow, which actually define what the
 // default constructor should instantiate.
+//
+// Only the small scalar attributes (pitch and value) are parsed this way.
+// Everything that owns heap memory is constructed by the builder instead, so
+// that no placeholder objects are ever allocated just to be thrown away.
 
 template <typename T>
 auto default_value = T{};
@@ -49,74 +59,13 @@ const auto default_value<stan::value> = stan::value{
     stan::value::quarter()
 };
 
-template <>
-const auto default_value<stan::rest> = stan::rest{
-    default_value<stan::value>
-};
-
-template <>
-const auto default_value<stan::note> = stan::note{
-    default_value<stan::value>,
-    default_value<stan::pitch>
-};
-
-template <>
-const auto default_value<stan::chord> = stan::chord{
-    default_value<stan::value>,
-    stan::pitch{ stan::pitchclass::c, stan::octave{ 4 } },
-    stan::pitch{ stan::pitchclass::e, stan::octave{ 4 } },
-    stan::pitch{ stan::pitchclass::g, stan::octave{ 4 } },
-};
-
-template <>
-const auto default_value<beam> = beam{
-    note{ value::eighth(), default_value<pitch> },
-    note{ value::eighth(), default_value<pitch> }
-};
-
-template <>
-const auto default_value<tuplet> = tuplet{
-    value::quarter(),
-    note{ value::eighth(), default_value<pitch> },
-    note{ value::eighth(), default_value<pitch> },
-    note{ value::eighth(), default_value<pitch> },
-
-};
-
-template <>
-const auto default_value<meter> = meter{
-    { 4 },
-    value::quarter()
-};
-
-template <>
-const auto default_value<clef> = clef { 
-	clef::type::treble
-};
-
-template <>
-const auto default_value<key> = key { 
-	pitchclass::c,
-	mode::major
-};
-
-template <>
-const auto default_value<stan::column> = stan::column{
-    default_value<stan::note>
-};
-
 } // namespace stan
 
 namespace boost::spirit::x3::traits {
 
-// Spirit X3 still uses the antique boost::variant for modeling choice values,
-// but the C++17 std::variant is used everywhere else in stan.  The template class
-// transform_attribute<> is X3's specialization hook to convert otherwise
-// incompatible attribute types, which in this case converts from
-// boost::variant<> to std::variant<>.  This method works perfect for what I
-// needed, but it did take a day's labor to figure this out.  If X3 ever gets
-// updated to replace boost::variant<> with std::variant<> under the covers,
-// this specialization may be removed.
+// The template class transform_attribute<> is X3's specialization hook to
+// convert otherwise incompatible attribute types, which in this case converts
+// between default_ctor<T> and the T that it wraps.
 
 template <typename T>
 struct transform_attribute<T, stan::default_ctor<T>, x3::parser_id>
@@ -174,14 +123,16 @@ struct clef_ : x3::symbols<stan::clef::type>
     }
 } clef;
 
-struct mode_ : x3::symbols<std::vector<std::uint8_t>>
+// The symbol table holds pointers, so that matching a mode does not copy the
+// mode's vector; the key makes the one copy it needs.
+struct mode_ : x3::symbols<const std::vector<std::uint8_t> *>
 {
     mode_()
     {
     // clang-format off
 	add
-	    ("\\major", stan::mode::major)
-	    ("\\minor", stan::mode::minor)
+	    ("\\major", &stan::mode::major)
+	    ("\\minor", &stan::mode::minor)
 	    ;
     // clang-format on
     }
@@ -237,15 +188,18 @@ using x3::ascii::char_;
 x3::rule<struct ppitch, default_ctor<stan::pitch>> ppitch = "pitch";
 x3::rule<struct poctave, stan::octave> poctave = "octave";
 x3::rule<struct pvalue, default_ctor<stan::value>> pvalue = "value";
-x3::rule<struct prest, default_ctor<stan::rest>> prest = "rest";
-x3::rule<struct pnote, default_ctor<stan::note>> pnote = "note";
-x3::rule<struct pchord, default_ctor<stan::chord>> pchord = "chord";
-x3::rule<struct pbeam, default_ctor<stan::beam>> pbeam = "beam";
-x3::rule<struct ptuplet, default_ctor<stan::tuplet>> ptuplet = "tuplet";
-x3::rule<struct pmeter, default_ctor<stan::meter>> pmeter = "meter";
-x3::rule<struct pclef, default_ctor<stan::clef>> pclef = "clef";
-x3::rule<struct pkey, default_ctor<stan::key>> pkey = "key";
-x3::rule<struct pcolumn, default_ctor<stan::column>> column = "column";
+
+// The column rules have no attributes; their semantic actions push finished
+// objects onto the builder instead.
+x3::rule<struct prest> prest = "rest";
+x3::rule<struct pnote> pnote = "note";
+x3::rule<struct pchord> pchord = "chord";
+x3::rule<struct pbeam> pbeam = "beam";
+x3::rule<struct ptuplet> ptuplet = "tuplet";
+x3::rule<struct pmeter> pmeter = "meter";
+x3::rule<struct pclef> pclef = "clef";
+x3::rule<struct pkey> pkey = "key";
+x3::rule<struct pcolumn> column = "column";
 
 // x3::rule<struct pmusic, std::shared_ptr<stan::column>> music = "music";
 // x3::rule<struct music_list, stan::sequential> music_list = "music_list";
@@ -296,63 +250,197 @@ struct construct<T>
     }
 };
 
-// Metaprogram to compute a boost::variant<> from std::variant<>.
-template <typename T>
-struct std_variant_to_boost;
+// The builder is passed to the semantic actions through the parser context.
+struct builder_tag
+{
+};
 
-template <typename... Ts>
-struct std_variant_to_boost<std::variant<Ts...>>
+auto get_builder = [](auto &ctx) -> builder & { return x3::get<builder_tag>(ctx); };
+
+template <typename T, int... ArgOrder>
+struct emit
 {
-    using type = boost::variant<Ts...>;
+    template <typename Context>
+    void operator()(Context &ctx)
+    {
+        get_builder(ctx).template emplace<T>(at_c<ArgOrder>(x3::_attr(ctx))...);
+    }
 };
 
-template <>
-struct construct<stan::column>
+template <typename T>
+struct emit<T>
 {
     template <typename Context>
     void operator()(Context &ctx)
     {
-        typename std_variant_to_boost<stan::column>::type v = x3::_attr(ctx);
-        x3::_val(ctx) = stan::column(stan::copy(v));
+        get_builder(ctx).template emplace<T>(x3::_attr(ctx));
     }
 };
 
-auto to_tuplet = [](auto &ctx) {
-    auto attr = _attr(ctx);
-    stan::value val = tuplet::scale(at_c<0>(attr), at_c<1>(attr), at_c<2>(attr));
-    x3::_val(ctx) = tuplet{ val, at_c<2>(attr) };
+auto open = [](auto &ctx) { get_builder(ctx).open(); };
+auto add_pitch = [](auto &ctx) { get_builder(ctx).add_pitch(_attr(ctx)); };
+auto close_chord = [](auto &ctx) { get_builder(ctx).close_chord(_attr(ctx)); };
+auto close_beam = [](auto &ctx) { get_builder(ctx).close_beam(); };
+
+auto close_tuplet = [](auto &ctx) {
+    auto &attr = _attr(ctx);
+    get_builder(ctx).close_tuplet(at_c<0>(attr), at_c<1>(attr));
 };
 
-auto to_meter = [](auto &ctx) {
-    auto attr = _attr(ctx);
+auto emit_meter = [](auto &ctx) {
+    auto &attr = _attr(ctx);
     // This works only for simple meter so far
-    x3::_val(ctx) = meter{
-        { static_cast<std::uint8_t>(at_c<0>(attr)) },
-        at_c<1>(attr)
-    };
+    get_builder(ctx).emplace_meter(static_cast<std::uint8_t>(at_c<0>(attr)), at_c<1>(attr));
+};
+
+auto emit_key = [](auto &ctx) {
+    auto &attr = _attr(ctx);
+    get_builder(ctx).emplace_key(at_c<0>(attr), *at_c<1>(attr));
+};
+
+// If an alternative fails part way through, anything it already pushed onto
+// the builder must be discarded before the next alternative is attempted.
+// guard[] is a directive that does exactly that.
+
+template <typename Subject>
+struct guard_directive : x3::unary_parser<Subject, guard_directive<Subject>>
+{
+    using base_type = x3::unary_parser<Subject, guard_directive<Subject>>;
+    static bool const is_pass_through_unary = true;
+
+    guard_directive(const Subject &subject) :
+        base_type(subject) {}
+
+    template <typename Iterator, typename Context, typename RContext, typename Attribute>
+    bool parse(Iterator &first, const Iterator &last, const Context &ctx,
+               RContext &rctx, Attribute &attr) const
+    {
+        builder &b = x3::get<builder_tag>(ctx);
+        builder::mark m = b.position();
+        if (this->subject.parse(first, last, ctx, rctx, attr)) {
+            return true;
+        }
+        b.rewind(m);
+        return false;
+    }
+};
+
+struct guard_gen
+{
+    template <typename Subject>
+    guard_directive<typename x3::extension::as_parser<Subject>::value_type>
+    operator[](const Subject &subject) const
+    {
+        return { x3::as_parser(subject) };
+    }
+};
+
+guard_gen const guard{};
+
+// The non-throwing interface reports where the parse failed and what was
+// expected there.  expecting(name)[p] records name whenever p fails at least
+// as far into the input as any earlier failure, so the furthest failure wins,
+// and on a tie, the enclosing rule wins over the rules it tried.  If the
+// notation model throws, the innermost expecting[] records where the rejected
+// object began.  Without a diagnostics object in the context, expecting[]
+// does nothing at all, so the throwing interface pays nothing for it.
+
+struct diagnostics_tag
+{
+};
+
+struct diagnostics
+{
+    const char *m_furthest = nullptr;
+    const char *m_expected = nullptr;
+    const char *m_rejected = nullptr;
+    const char *m_rejected_by = nullptr;
 };
 
-auto const prest_def = x3::lit('r') >> pvalue[construct<stan::rest>()];
-auto const pnote_def = (ppitch >> pvalue)[construct<stan::note, 1, 0>()];
-auto const ppitch_def = (pitchclass >> poctave)[construct<stan::pitch, 0, 1>()];
+template <typename Subject>
+struct expecting_directive : x3::unary_parser<Subject, expecting_directive<Subject>>
+{
+    using base_type = x3::unary_parser<Subject, expecting_directive<Subject>>;
+    static bool const is_pass_through_unary = true;
+
+    expecting_directive(const char *name, const Subject &subject) :
+        base_type(subject), m_name(name) {}
+
+    template <typename Iterator, typename Context, typename RContext, typename Attribute>
+    bool parse(Iterator &first, const Iterator &last, const Context &ctx,
+               RContext &rctx, Attribute &attr) const
+    {
+        auto &&d = x3::get<diagnostics_tag>(ctx);
+        if constexpr (std::is_same_v<std::decay_t<decltype(d)>, x3::unused_type>) {
+            return this->subject.parse(first, last, ctx, rctx, attr);
+        } else {
+            x3::skip_over(first, last, ctx);
+            Iterator start = first;
+            try {
+                if (this->subject.parse(first, last, ctx, rctx, attr)) {
+                    return true;
+                }
+            } catch (stan::exception &) {
+                if (d.m_rejected == nullptr) {
+                    d.m_rejected = start;
+                    d.m_rejected_by = m_name;
+                }
+                throw;
+            }
+            if (d.m_furthest == nullptr or start >= d.m_furthest) {
+                d.m_furthest = start;
+                d.m_expected = m_name;
+            }
+            return false;
+        }
+    }
+
+    const char *m_name;
+};
+
+struct expecting_gen
+{
+    const char *m_name;
+
+    template <typename Subject>
+    expecting_directive<typename x3::extension::as_parser<Subject>::value_type>
+    operator[](const Subject &subject) const
+    {
+        return { m_name, x3::as_parser(subject) };
+    }
+};
+
+expecting_gen expecting(const char *name)
+{
+    return { name };
+}
+
+auto const prest_def = expecting(prest.name)[x3::lit('r') >> pvalue[emit<stan::rest>()]];
+auto const pnote_def = expecting(pnote.name)[(ppitch >> pvalue)[emit<stan::note, 1, 0>()]];
+auto const ppitch_def =
+    expecting(ppitch.name)[(pitchclass >> poctave)[construct<stan::pitch, 0, 1>()]];
 
 auto add_dot = [](auto &ctx) { _val(ctx) = dot(_val(ctx)); };
 
-auto const pvalue_def =
-    basevalue[construct<stan::value>()] >> x3::repeat(0, 2)[lit('.')[add_dot]];
-auto const pchord_def = ('<' >> +ppitch >> '>' >> pvalue)[construct<stan::chord, 1, 0>()];
-auto const pbeam_def = '[' >> (+column)[construct<stan::beam>()] >> ']';
-auto const ptuplet_def =
-    (lit(R"(\tuplet)") >> x3::int_ >> '/' >> x3::int_ >> '{' >> (+column) >> '}')
-        [to_tuplet];
-auto const pmeter_def =
-    (lit(R"(\time)") >> x3::ushort_ >> '/' >> basevalue)[to_meter];
-auto const pclef_def =
-    (lit(R"(\clef)") >> clef)[construct<stan::clef>()];
-auto const pkey_def = 
-    (lit(R"(\key)") >> pitchclass >> mode)[construct<stan::key, 0, 1>()];
-auto const column_def = (prest | pnote | pchord | pbeam | ptuplet | pmeter | pclef | pkey)
-    [construct<stan::column>()];
+auto const pvalue_def = expecting(pvalue.name)[
+    basevalue[construct<stan::value>()] >> x3::repeat(0, 2)[lit('.')[add_dot]]];
+auto const pchord_def = expecting(pchord.name)[
+    '<' >> +ppitch[add_pitch] >> expecting("'>'")['>'] >> pvalue[close_chord]];
+auto const pbeam_def = expecting(pbeam.name)[
+    lit('[')[open] >> +column >> expecting("']'")[lit(']')][close_beam]];
+auto const ptuplet_def = expecting(ptuplet.name)[
+    (lit(R"(\tuplet)") >> expecting("integer")[x3::int_] >> expecting("'/'")['/'] >>
+     expecting("integer")[x3::int_] >> expecting("'{'")[lit('{')][open] >> +column >>
+     expecting("'}'")['}'])[close_tuplet]];
+auto const pmeter_def = expecting(pmeter.name)[
+    (lit(R"(\time)") >> expecting("integer")[x3::ushort_] >> expecting("'/'")['/'] >>
+     expecting(pvalue.name)[basevalue])[emit_meter]];
+auto const pclef_def = expecting(pclef.name)[
+    (lit(R"(\clef)") >> expecting("clef type")[clef])[emit<stan::clef>()]];
+auto const pkey_def = expecting(pkey.name)[
+    (lit(R"(\key)") >> expecting("pitch")[pitchclass] >> expecting("mode")[mode])[emit_key]];
+auto const column_def = expecting(column.name)[
+    guard[prest | pnote | pchord | pbeam | ptuplet | pmeter | pclef | pkey]];
 // auto make_shared = [](auto &ctx) { _val = std::make_shared<column>(std::move(_attr(ctx))); };
 // auto const music_def = column[make_shared];
 // auto const variant_def = note | chord_body | key | meter | clef ;
@@ -371,12 +459,135 @@ BOOST_SPIRIT_DEFINE(pclef)
 BOOST_SPIRIT_DEFINE(pkey)
 BOOST_SPIRIT_DEFINE(column)
 
-stan::column reader::operator()(const std::string &lily)
+// The reader's arena is a monotonic buffer resource over a buffer that the
+// reader owns.  When a parse needs more than the buffer holds, the monotonic
+// resource gets more from upstream, which counts how much.  release() then
+// grows the buffer by that much, so that the next time, it all fits.
+//
+// The buffer is not allowed to pin memory indefinitely, as a reader may live
+// as long as its thread does: it never grows past retained_limit, and once
+// several releases in a row have used only a small part of it, it shrinks to
+// twice the most any of them used.
+
+class reader::memory
 {
-    stan::column music{ stan::default_value<stan::note> };
+  public:
+    memory() { reset(); }
+
+    std::pmr::memory_resource *resource() { return &m_used; }
+
+    void release()
+    {
+        m_arena.reset();
+        std::size_t used = m_used.m_allocated;
+        if (m_upstream.m_allocated > 0) {
+            resize(std::min(m_size + m_upstream.m_allocated, retained_limit));
+            m_idle = 0;
+        } else if (used < m_size / 4 and m_size > initial_size) {
+            m_peak = std::max(m_peak, used);
+            if (++m_idle == shrink_after) {
+                resize(std::max(2 * m_peak, initial_size));
+                m_idle = 0;
+            }
+        } else {
+            m_idle = 0;
+        }
+        if (m_idle == 0) {
+            m_peak = 0;
+        }
+        m_used.m_allocated = 0;
+        m_upstream.m_allocated = 0;
+        reset();
+    }
+
+  private:
+    static constexpr std::size_t initial_size = 4096;
+    static constexpr std::size_t retained_limit = 16 * 1024 * 1024;
+    static constexpr int shrink_after = 8;
+
+    // Forwards to another resource, and counts how much it was asked for.
+    struct counting_resource : std::pmr::memory_resource
+    {
+        explicit counting_resource(std::pmr::memory_resource *r) :
+            m_resource(r) {}
+
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            m_allocated += bytes;
+            return m_resource->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override
+        {
+            m_resource->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &r) const noexcept override
+        {
+            return this == &r;
+        }
+
+        std::pmr::memory_resource *m_resource;
+        std::size_t m_allocated = 0;
+    };
+
+    void resize(std::size_t size)
+    {
+        if (size != m_size) {
+            m_size = size;
+            m_buffer = std::make_unique<std::byte[]>(m_size);
+        }
+    }
+
+    // The optional is emplaced in the same storage every time, so the
+    // builder's pointer to the arena stays valid.
+    void reset()
+    {
+        m_arena.emplace(m_buffer.get(), m_size, &m_upstream);
+        m_used.m_resource = &*m_arena;
+    }
+
+    counting_resource m_upstream{ std::pmr::new_delete_resource() };
+    std::size_t m_size = initial_size;
+    std::unique_ptr<std::byte[]> m_buffer = std::make_unique<std::byte[]>(m_size);
+    std::optional<std::pmr::monotonic_buffer_resource> m_arena;
+
+    // What the builder allocates goes through m_used, into the arena.
+    counting_resource m_used{ nullptr };
+    int m_idle = 0;
+    std::size_t m_peak = 0;
+};
+
+reader::reader() :
+    m_builder(std::make_unique<builder>())
+{
+}
+
+reader::reader(arena_t) :
+    m_arena(std::make_unique<memory>()),
+    m_builder(std::make_unique<builder>(m_arena->resource()))
+{
+}
+
+void reader::release()
+{
+    if (m_arena) {
+        m_builder->clear();
+        m_arena->release();
+    }
+}
+
+reader::reader(reader &&) noexcept = default;
+reader &reader::operator=(reader &&) noexcept = default;
+reader::~reader() = default;
+
+stan::column reader::operator()(std::string_view lily)
+{
+    m_builder->clear();
     auto iter = lily.begin();
 
-    if (!x3::phrase_parse(iter, lily.end(), column, x3::space, music)) {
+    auto const parser = x3::with<builder_tag>(*m_builder)[column];
+    if (!x3::phrase_parse(iter, lily.end(), parser, x3::space)) {
         throw std::runtime_error("parse error");
     }
 
@@ -384,7 +595,217 @@ stan::column reader::operator()(const std::string &lily)
         throw std::runtime_error("incomplete parse");
     }
 
-    return std::move(music);
+    return m_builder->pop();
+}
+
+void reader::append(std::string_view lily, std::vector<stan::column> &music)
+{
+    auto iter = lily.begin();
+    auto const parser = x3::with<builder_tag>(*m_builder)[column];
+
+    // One column at a time, so that the builder's stack stays small.
+    while (x3::phrase_parse(iter, lily.end(), x3::eps, x3::space), iter != lily.end()) {
+        m_builder->clear();
+        if (!x3::phrase_parse(iter, lily.end(), parser, x3::space)) {
+            throw std::runtime_error("parse error");
+        }
+        music.push_back(m_builder->pop());
+    }
+}
+
+// Parse one column starting at first, without throwing.  On success, the
+// column is left on the builder and first is advanced just past it.
+static std::optional<parse_error> try_column(std::string_view lily, const char *&first,
+                                             builder &b)
+{
+    const char *last = lily.data() + lily.size();
+    diagnostics d;
+
+    b.clear();
+    auto const parser = x3::with<builder_tag>(b)[x3::with<diagnostics_tag>(d)[column]];
+    try {
+        if (x3::phrase_parse(first, last, parser, x3::space, x3::skip_flag::dont_post_skip)) {
+            return std::nullopt;
+        }
+    } catch (stan::exception &e) {
+        return parse_error{ static_cast<std::size_t>(d.m_rejected - lily.data()),
+                            d.m_rejected_by, e.what() };
+    }
+
+    return parse_error{ static_cast<std::size_t>(d.m_furthest - lily.data()),
+                        d.m_expected, "parse error" };
+}
+
+result<stan::column> reader::parse(std::string_view lily)
+{
+    const char *first = lily.data();
+    if (auto error = try_column(lily, first, *m_builder)) {
+        return std::move(*error);
+    }
+
+    const char *last = lily.data() + lily.size();
+    x3::phrase_parse(first, last, x3::eps, x3::space);
+    if (first != last) {
+        return parse_error{ static_cast<std::size_t>(first - lily.data()),
+                            "end of input", "incomplete parse" };
+    }
+
+    return m_builder->pop();
+}
+
+// A bracket that nothing closes, or that closes nothing, is an error of its
+// own.  The parse of a column stops short of it, and the search for the next
+// column boundary reads it as whitespace, so that it does not take the rest
+// of the input with it.
+void recover_columns(std::string_view lily, builder &b, const recover_item &item)
+{
+    std::vector<std::size_t> unmatched = unmatched_brackets(lily);
+    auto u = unmatched.begin();
+
+    const char *first = lily.data();
+    const char *last = lily.data() + lily.size();
+
+    while (x3::phrase_parse(first, last, x3::eps, x3::space), first != last) {
+        std::size_t start = first - lily.data();
+        u = std::lower_bound(u, unmatched.end(), start);
+        std::size_t stop = u == unmatched.end() ? lily.size() : *u;
+        if (auto error = try_column(lily.substr(0, stop), first, b)) {
+            std::size_t next = next_boundary(lily, start, u, unmatched.end());
+            first = lily.data() + next;
+            item(start, next, std::move(*error));
+        } else {
+            item(start, first - lily.data(), b.pop());
+        }
+    }
+}
+
+std::vector<parse_error> reader::recover(std::string_view lily,
+                                         std::vector<stan::column> &music)
+{
+    std::vector<parse_error> errors;
+    recover_columns(lily, *m_builder, [&](std::size_t, std::size_t, result<stan::column> &&r) {
+        if (r) {
+            music.push_back(std::move(*r));
+        } else {
+            errors.push_back(r.error());
+        }
+    });
+    return errors;
+}
+
+// Sequences are parsed with the same column grammar as above, but one column
+// per call to next().  The template parameter is the input iterator type; for
+// streams, it is a Spirit multi_pass iterator, which buffers only as much
+// input as the current column needs for backtracking and discards the rest
+// whenever the parser holds the only copy of the iterator.
+
+struct sequence_reader::source
+{
+    virtual ~source() = default;
+    virtual std::optional<stan::column> next() = 0;
+};
+
+template <typename Iterator>
+struct sequence_source : sequence_reader::source
+{
+    sequence_source(Iterator first, Iterator last) :
+        m_first(std::move(first)), m_last(std::move(last)) {}
+
+    std::optional<stan::column> next() override
+    {
+        switch (m_state) {
+        case state::start:
+            if (!x3::phrase_parse(m_first, m_last, lit('{'), x3::space)) {
+                throw std::runtime_error("parse error");
+            }
+            m_state = state::body;
+            break;
+        case state::body:
+            break;
+        case state::done:
+            return std::nullopt;
+        }
+
+        if (x3::phrase_parse(m_first, m_last, lit('}'), x3::space)) {
+            m_state = state::done;
+            x3::phrase_parse(m_first, m_last, x3::eps, x3::space);
+            if (m_first != m_last) {
+                throw std::runtime_error("incomplete parse");
+            }
+            return std::nullopt;
+        }
+
+        m_builder.clear();
+        auto const parser = x3::with<builder_tag>(m_builder)[column];
+        if (!x3::phrase_parse(m_first, m_last, parser, x3::space)) {
+            throw std::runtime_error("parse error");
+        }
+        return m_builder.pop();
+    }
+
+  private:
+    enum struct state
+    {
+        start,
+        body,
+        done
+    };
+
+    Iterator m_first;
+    Iterator m_last;
+    state m_state = state::start;
+    builder m_builder;
+};
+
+// The mapping must live exactly as long as the iterators pointing into it.
+struct mapped_source : sequence_source<const char *>
+{
+    mapped_source(mapped_file &&file) :
+        sequence_source<const char *>(file.view().begin(), file.view().end()),
+        m_file(std::move(file)) {}
+
+  private:
+    mapped_file m_file;
+};
+
+sequence_reader::sequence_reader(std::istream &is)
+{
+    using base_iterator = std::istreambuf_iterator<char>;
+    using iterator = boost::spirit::multi_pass<base_iterator>;
+
+    is.unsetf(std::ios::skipws);
+    m_source = std::make_unique<sequence_source<iterator>>(
+        boost::spirit::make_default_multi_pass(base_iterator(is)),
+        boost::spirit::make_default_multi_pass(base_iterator()));
+}
+
+sequence_reader::sequence_reader(std::string_view lily) :
+    m_source(std::make_unique<sequence_source<const char *>>(lily.begin(), lily.end()))
+{
+}
+
+sequence_reader::sequence_reader(mapped_file &&file) :
+    m_source(std::make_unique<mapped_source>(std::move(file)))
+{
+}
+
+sequence_reader::sequence_reader(sequence_reader &&) noexcept = default;
+sequence_reader &sequence_reader::operator=(sequence_reader &&) noexcept = default;
+sequence_reader::~sequence_reader() = default;
+
+std::optional<stan::column> sequence_reader::next()
+{
+    return m_source->next();
+}
+
+sequence_reader::iterator sequence_reader::begin()
+{
+    return iterator(this);
+}
+
+sequence_reader::iterator sequence_reader::end()
+{
+    return iterator();
 }
 
 } // namespace stan::lilypond
@@ -3,6 +3,7 @@
 #include <stan/driver/lilypond.hpp>
 #include <stan/driver/debug.hpp>
 
+#include <iterator>
 #include <numeric>
 
 namespace stan::lilypond {
@@ -10,127 +11,137 @@ namespace stan::lilypond {
 driver::debug::writer debug;
 
 template <>
-std::string writer::operator()<value>(const value &v) const
+void writer::write_to<pitch>(fmt::memory_buffer &, const pitch &) const;
+template <>
+void writer::write_to<column>(fmt::memory_buffer &, const column &) const;
+
+namespace {
+
+void append(fmt::memory_buffer &out, std::string_view s)
+{
+    out.append(s.data(), s.data() + s.size());
+}
+
+// Each element, separated by single spaces.
+template <typename Range>
+void append_all(fmt::memory_buffer &out, const Range &elements)
+{
+    static writer write;
+
+    bool first = true;
+    for (const auto &e : elements) {
+        if (!first) {
+            out.push_back(' ');
+        }
+        first = false;
+        write.write_to(out, e);
+    }
+}
+
+} // namespace
+
+template <>
+void writer::write_to<value>(fmt::memory_buffer &out, const value &v) const
 {
     if (v == value::instantaneous()) {
-        return std::string();
+        return;
     }
 
-    return std::to_string(v.den() / (1u << v.dots())) + std::string(v.dots(), '.');
+    fmt::format_to(std::back_inserter(out), "{}", v.den() / (1u << v.dots()));
+    for (std::size_t i = 0; i < v.dots(); ++i) {
+        out.push_back('.');
+    }
 }
 
 template <>
-std::string writer::operator()<pitchclass>(const pitchclass &v) const
+void writer::write_to<pitchclass>(fmt::memory_buffer &out, const pitchclass &v) const
 {
-    return pitchclass_names.at(v);
+    append(out, pitchclass_names.at(v));
 }
 
 template <>
-std::string writer::operator()<octave>(const octave &v) const
+void writer::write_to<octave>(fmt::memory_buffer &out, const octave &v) const
 {
     std::int16_t cast = static_cast<std::uint8_t>(v) - 4;
-    return std::string(std::max<std::int16_t>(cast, 0), '\'') +
-        std::string(-std::min<std::int16_t>(cast, 0), ',');
+    for (std::int16_t i = 0; i < cast; ++i) {
+        out.push_back('\'');
+    }
+    for (std::int16_t i = 0; i > cast; --i) {
+        out.push_back(',');
+    }
 }
 
 template <>
-std::string writer::operator()<pitch>(const pitch &v) const
+void writer::write_to<pitch>(fmt::memory_buffer &out, const pitch &v) const
 {
-    writer write;
-    return write(v.m_pitchclass) + write(v.m_octave);
+    write_to(out, v.m_pitchclass);
+    write_to(out, v.m_octave);
 }
 
 template <>
-std::string writer::operator()<rest>(const rest &v) const
+void writer::write_to<rest>(fmt::memory_buffer &out, const rest &v) const
 {
-    writer write;
-    return fmt::format("r{}", write(v.m_value));
+    out.push_back('r');
+    write_to(out, v.m_value);
 }
 
 template <>
-std::string writer::operator()<note>(const note &v) const
+void writer::write_to<note>(fmt::memory_buffer &out, const note &v) const
 {
-    writer write;
-    return write(v.m_pitch) + write(v.m_value);
+    write_to(out, v.m_pitch);
+    write_to(out, v.m_value);
 }
 
 template <>
-std::string writer::operator()<chord>(chord const &r) const
+void writer::write_to<chord>(fmt::memory_buffer &out, chord const &r) const
 {
-    static writer write;
-
-    std::string pitches = std::accumulate(
-        r.m_pitches.begin(),
-        r.m_pitches.end(),
-        std::string(),
-        [](std::string res, pitch p) { return res + write(p) + " "; });
-    pitches.resize(pitches.size() - 1);
-    return fmt::format("<{}>{}", pitches, write(r.m_value));
+    out.push_back('<');
+    append_all(out, r.m_pitches);
+    out.push_back('>');
+    write_to(out, r.m_value);
 }
 
 template <>
-std::string writer::operator()<beam>(beam const &r) const
+void writer::write_to<beam>(fmt::memory_buffer &out, beam const &r) const
 {
-    static writer write;
-
-    std::string elements = std::accumulate(
-        r.m_elements.begin(),
-        r.m_elements.end(),
-        std::string(),
-        [](std::string res, const auto &p) { return res + write(p) + " "; });
-    elements.resize(elements.size() - 1);
-    return fmt::format("[{}]", elements);
+    out.push_back('[');
+    append_all(out, r.m_elements);
+    out.push_back(']');
 }
 
 template <>
-std::string writer::operator()<tuplet>(tuplet const &r) const
+void writer::write_to<tuplet>(fmt::memory_buffer &out, tuplet const &r) const
 {
-    static writer write;
-
-    std::string elements = std::accumulate(
-        r.m_elements.begin(),
-        r.m_elements.end(),
-        std::string(),
-        [](std::string res, const auto &p) { return res + write(p) + " "; });
-    elements.resize(elements.size() - 1);
-
-    duration inside = std::accumulate(
-        r.m_elements.begin(),
-        r.m_elements.end(),
-        duration::zero(),
-        [](duration res, const auto &p) { return res + p; });
-
-    duration outside = r.m_value;
-
-    float fi = inside;
-    float fo = outside;
-    auto scale = rational<std::uint16_t>::quantize(fi / fo);
-    return fmt::format(R"(\tuplet {}/{} {{{}}})", scale.num(), scale.den(), elements);
+    fmt::format_to(std::back_inserter(out), R"(\tuplet {}/{} {{)", r.num(), r.den());
+    append_all(out, r.m_elements);
+    out.push_back('}');
 }
 
 template <>
-std::string writer::operator()<meter>(const meter &m) const
+void writer::write_to<meter>(fmt::memory_buffer &out, const meter &m) const
 {
-    static writer write;
     if (m.m_beats.size() == 1) {
-        return fmt::format(R"(\time {}/{})", m.m_beats.front(), m.m_value.den());
+        fmt::format_to(std::back_inserter(out), R"(\time {}/{})", m.m_beats.front(),
+                       m.m_value.den());
+        return;
     }
 
-    std::string compound = std::accumulate(
-        m.m_beats.begin(),
-        m.m_beats.end(),
-        std::string(),
-        [v = m.m_value](std::string s, std::uint8_t beats) {
-            return fmt::format("{}({} {}) ", s, beats, v.den());
-        });
-    compound.erase(compound.end() - 1);
-    return fmt::format(R"(\compoundMeter #'({}))", compound);
+    append(out, R"(\compoundMeter #'()");
+    bool first = true;
+    for (std::uint8_t beats : m.m_beats) {
+        if (!first) {
+            out.push_back(' ');
+        }
+        first = false;
+        fmt::format_to(std::back_inserter(out), "({} {})", beats, m.m_value.den());
+    }
+    out.push_back(')');
 }
 
 template <>
-std::string writer::operator()<clef>(const clef &c) const
+void writer::write_to<clef>(fmt::memory_buffer &out, const clef &c) const
 {
-	static std::map<clef::type, std::string> name {
+	static std::map<clef::type, std::string_view> name {
 		{ clef::type::treble, "treble" },
 		{ clef::type::alto, "alto" },
 		{ clef::type::tenor, "tenor" },
@@ -138,30 +149,32 @@ std::string writer::operator()<clef>(const clef &c) const
 		{ clef::type::percussion, "percussion" },
 	};
 
-	return fmt::format(R"(\clef {})", name.at(c.m_type));
+	append(out, R"(\clef )");
+	append(out, name.at(c.m_type));
 }
 
 template <>
-std::string writer::operator()<key>(const key &k) const
+void writer::write_to<key>(fmt::memory_buffer &out, const key &k) const
 {
-    if (k == key(k.m_tonic, mode::major))
+    if (k.major())
     {
-	return fmt::format(R"(\key {} \major)", pitchclass_names.at(k.m_tonic));
+	fmt::format_to(std::back_inserter(out), R"(\key {} \major)", pitchclass_names.at(k.m_tonic));
+	return;
     }
 
-    if (k == key(k.m_tonic, mode::minor))
+    if (k.minor())
     {
-	return fmt::format(R"(\key {} \minor)", pitchclass_names.at(k.m_tonic));
+	fmt::format_to(std::back_inserter(out), R"(\key {} \minor)", pitchclass_names.at(k.m_tonic));
+	return;
     }
 
     throw invalid_key("key is neither major nor minor");
 }
 
 template <>
-std::string writer::operator()<column>(const column &v) const
+void writer::write_to<column>(fmt::memory_buffer &out, const column &v) const
 {
-    static writer write;
-    return std::visit([](auto &&ev) { return write(ev); }, v);
+    std::visit([this, &out](auto &&ev) { write_to(out, ev); }, v);
 }
 
 } // namespace stan::lilypond
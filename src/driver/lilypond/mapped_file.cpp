@@ -0,0 +1,70 @@
+#include <stan/driver/lilypond.hpp>
+#include <stan/exception.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+namespace stan::lilypond {
+
+mapped_file::mapped_file(const std::string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw exception("cannot open {}: {}", path, std::strerror(errno));
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw exception("cannot stat {}: {}", path, std::strerror(error));
+    }
+
+    // mmap() refuses zero length mappings, but an empty file is still a
+    // perfectly good (if unparseable) input.
+    m_size = static_cast<std::size_t>(st.st_size);
+    if (m_size > 0) {
+        void *data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            int error = errno;
+            ::close(fd);
+            throw exception("cannot map {}: {}", path, std::strerror(error));
+        }
+
+        // The reader makes a single forward pass, apart from backtracking
+        // within a column.
+        ::madvise(data, m_size, MADV_SEQUENTIAL);
+        m_data = static_cast<const char *>(data);
+    }
+
+    // The mapping holds its own reference to the file.
+    ::close(fd);
+}
+
+mapped_file::mapped_file(mapped_file &&other) noexcept :
+    m_data(std::exchange(other.m_data, nullptr)),
+    m_size(std::exchange(other.m_size, 0))
+{
+}
+
+mapped_file &mapped_file::operator=(mapped_file &&other) noexcept
+{
+    std::swap(m_data, other.m_data);
+    std::swap(m_size, other.m_size);
+    return *this;
+}
+
+mapped_file::~mapped_file()
+{
+    if (m_data != nullptr) {
+        ::munmap(const_cast<char *>(m_data), m_size);
+    }
+}
+
+} // namespace stan::lilypond
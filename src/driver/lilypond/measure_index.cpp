@@ -0,0 +1,382 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include <stan/exception.hpp>
+
+#include "builder.hpp"
+#include "recover.hpp"
+#include "scanner.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory_resource>
+#include <utility>
+
+namespace stan::lilypond {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char magic[8] = { 's', 't', 'a', 'n', '.', 'i', 'd', 'x' };
+constexpr std::size_t header_size = 56;
+constexpr std::size_t bar_size = 16;
+constexpr std::size_t checksum_size = 8;
+
+std::uint64_t fnv1a(std::string_view bytes)
+{
+    std::uint64_t hash = 0xcbf29ce484222325u;
+    for (char c : bytes) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3u;
+    }
+    return hash;
+}
+
+std::int64_t modification_time(const std::string &path)
+{
+    std::error_code error;
+    fs::file_time_type time = fs::last_write_time(path, error);
+    if (error) {
+        throw exception("cannot stat {}: {}", path, error.message());
+    }
+    return time.time_since_epoch().count();
+}
+
+template <typename Integer>
+void put(std::string &out, Integer n)
+{
+    for (std::size_t i = 0; i < sizeof(Integer); ++i) {
+        out += static_cast<char>(static_cast<std::uint64_t>(n) >> (8 * i));
+    }
+}
+
+template <typename Integer>
+Integer get(const char *in)
+{
+    std::uint64_t n = 0;
+    for (std::size_t i = 0; i < sizeof(Integer); ++i) {
+        n |= std::uint64_t{ static_cast<unsigned char>(in[i]) } << (8 * i);
+    }
+    return static_cast<Integer>(n);
+}
+
+// Musical time within the current measure.  Durations are rationals of 32
+// bit integers, whose products overflow over a long score, so positions are
+// kept separately, with 64 bit integers.
+struct fraction
+{
+    std::uint64_t m_num;
+    std::uint64_t m_den;
+
+    fraction &operator+=(const fraction &f)
+    {
+        m_num = m_num * f.m_den + f.m_num * m_den;
+        m_den *= f.m_den;
+        std::uint64_t a = m_num;
+        std::uint64_t b = m_den;
+        while (b != 0) {
+            a = std::exchange(b, a % b);
+        }
+        m_num /= a;
+        m_den /= a;
+        return *this;
+    }
+
+    // Only ever called with *this >= f.
+    fraction &operator-=(const fraction &f)
+    {
+        m_num = m_num * f.m_den - f.m_num * m_den;
+        m_den *= f.m_den;
+        return *this += fraction{ 0, 1 };
+    }
+
+    friend bool operator>=(const fraction &f1, const fraction &f2)
+    {
+        return f1.m_num * f2.m_den >= f2.m_num * f1.m_den;
+    }
+};
+
+fraction length(const stan::column &c)
+{
+    duration d = duration::zero() + c;
+    return { d.num(), d.den() };
+}
+
+// What is in effect at the current point of the music.
+struct state
+{
+    void operator()(const stan::meter &m)
+    {
+        m_beats = 0;
+        for (std::uint8_t b : m.m_beats) {
+            m_beats += b;
+        }
+        m_value = static_cast<std::uint8_t>(m.m_value.den());
+    }
+
+    void operator()(const stan::clef &c) { m_clef = c.m_type; }
+
+    void operator()(const stan::key &k)
+    {
+        m_tonic = k.m_tonic;
+        m_mode = k.minor() ? 1 : 0;
+    }
+
+    template <typename Column>
+    void operator()(const Column &) {}
+
+    fraction measure() const { return { m_beats, m_value }; }
+
+    pitchclass m_tonic = pitchclass::c;
+    std::uint8_t m_mode = 0;
+    clef::type m_clef = clef::type::treble;
+    std::uint8_t m_beats = 4;
+    std::uint8_t m_value = 4;
+};
+
+// Whether every field of a bar read from a sidecar is one that build() could
+// have written, so that nothing read from disk is cast to an enumerator that
+// does not exist.
+bool valid(const measure_index::bar &b, std::uint64_t end)
+{
+    static const valid_pitchclass pitchclasses;
+
+    auto type = static_cast<std::uint8_t>(b.m_clef);
+    bool power_of_two = b.m_value != 0 and (b.m_value & (b.m_value - 1)) == 0;
+    return b.m_offset < end and pitchclasses.count(b.m_tonic) != 0 and b.m_mode <= 1 and
+        type <= static_cast<std::uint8_t>(clef::type::percussion) and power_of_two and
+        b.m_value <= 64;
+}
+
+} // namespace
+
+measure_index measure_index::build(const std::string &path)
+{
+    mapped_file file(path);
+    std::string_view lily = file.view();
+    std::optional<std::string_view> body = sequence_body(lily);
+    if (!body) {
+        throw std::runtime_error("parse error");
+    }
+    std::size_t base = body->data() - lily.data();
+
+    measure_index index;
+    index.m_size = lily.size();
+    index.m_time = modification_time(path);
+    index.m_hash = fnv1a(lily);
+    index.m_end = base + body->size();
+
+    std::pmr::monotonic_buffer_resource pool;
+    builder b(&pool);
+    state in_effect;
+    fraction position{ 0, 1 };
+    std::size_t start = 0;
+    std::size_t columns = 0;
+
+    // The text between two boundaries may hold several columns, as in
+    // "d4[e8 f8]", and a bar may begin at any of them, so each is read with
+    // its own offset.
+    auto chunk = [&](std::size_t last) {
+        std::string_view text = body->substr(start, last - start);
+        recover_columns(text, b, [&](std::size_t first, std::size_t, result<stan::column> &&r) {
+            if (!r) {
+                // Read it again to throw what reading the whole sequence would.
+                std::vector<stan::column> rest;
+                reader().append(text.substr(first), rest);
+                throw std::runtime_error(r.error().m_message);
+            }
+
+            std::uint64_t offset = base + start + first;
+            if (index.m_bars.empty()) {
+                index.m_bars.push_back({ offset, in_effect.m_tonic, in_effect.m_mode,
+                                         in_effect.m_clef, in_effect.m_beats,
+                                         in_effect.m_value });
+            }
+            while (in_effect.m_beats != 0 and position >= in_effect.measure()) {
+                position -= in_effect.measure();
+                index.m_bars.push_back({ offset, in_effect.m_tonic, in_effect.m_mode,
+                                         in_effect.m_clef, in_effect.m_beats,
+                                         in_effect.m_value });
+            }
+
+            std::visit(in_effect, *r);
+            position += length(*r);
+            ++columns;
+        });
+
+        // The columns are only needed for their durations, so the pool is
+        // emptied every so often to keep memory bounded.
+        if (columns >= 4096) {
+            b.clear();
+            pool.release();
+            columns = 0;
+        }
+    };
+
+    boundary_scanner scanner;
+    auto boundary = [&](std::size_t offset) {
+        chunk(offset);
+        start = offset;
+    };
+    scanner.scan(*body, boundary);
+    scanner.finish(boundary);
+    if (scanner.depth() != 0) {
+        throw std::runtime_error("parse error");
+    }
+    chunk(body->size());
+
+    return index;
+}
+
+measure_index measure_index::load(const std::string &sidecar)
+{
+    std::ifstream in(sidecar, std::ios::binary);
+    if (!in) {
+        throw exception("cannot open {}", sidecar);
+    }
+    std::string data{ std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+
+    if (data.size() < header_size or std::memcmp(data.data(), magic, sizeof(magic)) != 0) {
+        throw exception("{} is not a measure index", sidecar);
+    }
+    const char *p = data.data() + sizeof(magic);
+    if (auto v = get<std::uint32_t>(p); v != version) {
+        throw exception("{} is a measure index of version {}, not {}", sidecar, v, version);
+    }
+
+    std::string_view body(data.data(), data.size() - std::min(data.size(), checksum_size));
+    if (data.size() < header_size + checksum_size or
+        get<std::uint64_t>(data.data() + body.size()) != fnv1a(body)) {
+        throw exception("{} is damaged", sidecar);
+    }
+
+    measure_index index;
+    index.m_size = get<std::uint64_t>(p + 8);
+    index.m_time = get<std::int64_t>(p + 16);
+    index.m_hash = get<std::uint64_t>(p + 24);
+    index.m_end = get<std::uint64_t>(p + 32);
+    auto count = get<std::uint64_t>(p + 40);
+    if ((body.size() - header_size) / bar_size != count or
+        (body.size() - header_size) % bar_size != 0 or index.m_end >= index.m_size) {
+        throw exception("{} is damaged", sidecar);
+    }
+
+    index.m_bars.reserve(count);
+    for (p = data.data() + header_size; p != body.data() + body.size(); p += bar_size) {
+        bar b{ get<std::uint64_t>(p), static_cast<pitchclass>(p[8]),
+               static_cast<std::uint8_t>(p[9]), static_cast<clef::type>(p[10]),
+               static_cast<std::uint8_t>(p[11]), static_cast<std::uint8_t>(p[12]) };
+        if (!valid(b, index.m_end) or p[13] != 0 or p[14] != 0 or p[15] != 0 or
+            (!index.m_bars.empty() and b.m_offset < index.m_bars.back().m_offset)) {
+            throw exception("{} is damaged", sidecar);
+        }
+        index.m_bars.push_back(b);
+    }
+    return index;
+}
+
+void measure_index::save(const std::string &sidecar) const
+{
+    std::string data(magic, sizeof(magic));
+    data.reserve(header_size + bar_size * m_bars.size() + checksum_size);
+    put(data, version);
+    put(data, std::uint32_t{ 0 });
+    put(data, m_size);
+    put(data, m_time);
+    put(data, m_hash);
+    put(data, m_end);
+    put(data, std::uint64_t{ m_bars.size() });
+    for (const bar &b : m_bars) {
+        put(data, b.m_offset);
+        put(data, static_cast<std::uint8_t>(b.m_tonic));
+        put(data, b.m_mode);
+        put(data, static_cast<std::uint8_t>(b.m_clef));
+        put(data, b.m_beats);
+        put(data, b.m_value);
+        data.append(3, '\0');
+    }
+    put(data, fnv1a(data));
+
+    std::ofstream out(sidecar, std::ios::binary | std::ios::trunc);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!out.flush()) {
+        throw exception("cannot write {}", sidecar);
+    }
+}
+
+measure_index measure_index::open(const std::string &path)
+{
+    std::string sidecar = path + ".idx";
+    try {
+        measure_index index = load(sidecar);
+        if (index.current(path)) {
+            return index;
+        }
+    } catch (const exception &) {
+        // Missing, damaged or of another version, so build it again.
+    }
+
+    measure_index index = build(path);
+    index.save(sidecar);
+    return index;
+}
+
+bool measure_index::current(const std::string &path) const
+{
+    std::error_code error;
+    std::uintmax_t size = fs::file_size(path, error);
+    if (error or size != m_size) {
+        return false;
+    }
+    if (modification_time(path) == m_time) {
+        return true;
+    }
+    return fnv1a(mapped_file(path).view()) == m_hash;
+}
+
+stan::key measure_index::key(std::size_t measure) const
+{
+    const bar &b = m_bars.at(measure);
+    return { b.m_tonic, b.m_mode == 0 ? mode::major_degrees : mode::minor_degrees };
+}
+
+stan::clef measure_index::clef(std::size_t measure) const
+{
+    return { m_bars.at(measure).m_clef };
+}
+
+stan::meter measure_index::meter(std::size_t measure) const
+{
+    const bar &b = m_bars.at(measure);
+    for (const value &v : value::all) {
+        if (v.num() == 1 and v.den() == b.m_value) {
+            return { std::vector<std::uint8_t>{ b.m_beats }, v };
+        }
+    }
+    throw exception("measure {} has no valid meter", measure);
+}
+
+std::vector<column> measure_index::measures(std::string_view lily, std::size_t first,
+                                            std::size_t last, reader &read) const
+{
+    if (lily.size() != m_size) {
+        throw exception("text of {} bytes is not the indexed text of {} bytes", lily.size(),
+                        m_size);
+    }
+    if (first > last or last > m_bars.size()) {
+        throw exception("measures [{}, {}) out of range, there are {}", first, last,
+                        m_bars.size());
+    }
+
+    std::vector<column> music;
+    if (first != last) {
+        std::uint64_t begin = m_bars[first].m_offset;
+        std::uint64_t end = last < m_bars.size() ? m_bars[last].m_offset : m_end;
+        read.append(lily.substr(begin, end - begin), music);
+    }
+    return music;
+}
+
+} // namespace stan::lilypond
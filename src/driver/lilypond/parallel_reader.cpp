@@ -0,0 +1,84 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include <stan/thread_pool.hpp>
+
+#include "scanner.hpp"
+
+#include <future>
+
+namespace stan::lilypond {
+
+parallel_reader::parallel_reader(thread_pool &pool, std::size_t minimum_chunk) :
+    m_pool(pool), m_minimum_chunk(std::max<std::size_t>(minimum_chunk, 1))
+{
+}
+
+std::vector<column> parallel_reader::operator()(std::string_view lily)
+{
+    // Malformed input takes the sequential path, which reports exactly the
+    // same error that sequence_reader would.
+    auto sequential = [lily] {
+        std::vector<column> music;
+        for (auto &c : sequence_reader(lily)) {
+            music.push_back(std::move(c));
+        }
+        return music;
+    };
+
+    std::optional<std::string_view> body = sequence_body(lily);
+    if (!body) {
+        return sequential();
+    }
+
+    // Several chunks per thread, so that one slow chunk does not leave the
+    // other threads idle at the end.
+    std::size_t chunks = std::min(m_pool.size() * 4, body->size() / m_minimum_chunk);
+    std::size_t target = body->size() / std::max<std::size_t>(chunks, 1);
+
+    std::vector<std::size_t> splits{ 0 };
+    boundary_scanner scanner;
+    if (chunks > 1) {
+        scanner.scan(*body, [&splits, target](std::size_t offset) {
+            if (offset >= splits.back() + target) {
+                splits.push_back(offset);
+            }
+        });
+    }
+    splits.push_back(body->size());
+
+    std::vector<std::future<std::vector<column>>> parts;
+    for (std::size_t i = 0; i + 1 < splits.size(); ++i) {
+        std::string_view chunk = body->substr(splits[i], splits[i + 1] - splits[i]);
+        parts.push_back(m_pool.submit([chunk] {
+            std::vector<column> music;
+            reader().append(chunk, music);
+            return music;
+        }));
+    }
+
+    std::vector<std::vector<column>> results;
+    bool failed = false;
+    for (auto &part : parts) {
+        try {
+            results.push_back(part.get());
+        } catch (std::exception &) {
+            failed = true;
+        }
+    }
+    if (failed) {
+        return sequential();
+    }
+
+    std::size_t size = 0;
+    for (const auto &r : results) {
+        size += r.size();
+    }
+    std::vector<column> music = std::move(results.front());
+    music.reserve(size);
+    for (std::size_t i = 1; i < results.size(); ++i) {
+        std::move(results[i].begin(), results[i].end(), std::back_inserter(music));
+    }
+    return music;
+}
+
+} // namespace stan::lilypond
@@ -0,0 +1,135 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include <stan/exception.hpp>
+#include <stan/thread_pool.hpp>
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <future>
+
+namespace stan::lilypond {
+
+namespace {
+
+constexpr std::string_view open_sequence = "{ ";
+constexpr std::string_view close_sequence = "}\n";
+
+// pwrite() may write less than it was given.
+void write_at(int fd, std::string_view text, off_t offset)
+{
+    while (!text.empty()) {
+        ssize_t written = ::pwrite(fd, text.data(), text.size(), offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw exception("cannot write the sequence: {}", std::strerror(errno));
+        }
+        text.remove_prefix(static_cast<std::size_t>(written));
+        offset += written;
+    }
+}
+
+// Every task must be waited for, as each refers to the caller's buffers, and
+// then the exception of the earliest range that failed is rethrown.
+template <typename T, typename Result>
+void join(std::vector<std::future<T>> &tasks, Result &&result)
+{
+    std::exception_ptr error;
+    for (auto &t : tasks) {
+        try {
+            result(t);
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace
+
+parallel_writer::parallel_writer(thread_pool &pool, std::size_t minimum_range) :
+    m_pool(pool), m_minimum_range(std::max<std::size_t>(minimum_range, 1))
+{
+}
+
+// Each column with the space after it, as sequence_writer writes them.
+std::vector<fmt::memory_buffer> parallel_writer::format(const std::vector<column> &music) const
+{
+    // Several ranges per thread, so that one slow range does not leave the
+    // other threads idle at the end.
+    std::size_t ranges = std::min(m_pool.size() * 4, music.size() / m_minimum_range);
+    ranges = std::max<std::size_t>(ranges, 1);
+
+    std::vector<std::future<fmt::memory_buffer>> tasks;
+    for (std::size_t i = 0; i < ranges; ++i) {
+        auto first = music.begin() + music.size() * i / ranges;
+        auto last = music.begin() + music.size() * (i + 1) / ranges;
+        tasks.push_back(m_pool.submit([first, last] {
+            writer write;
+            fmt::memory_buffer out;
+            for (auto c = first; c != last; ++c) {
+                write.write_to(out, *c);
+                out.push_back(' ');
+            }
+            return out;
+        }));
+    }
+
+    std::vector<fmt::memory_buffer> buffers;
+    buffers.reserve(ranges);
+    join(tasks, [&buffers](auto &t) { buffers.push_back(t.get()); });
+    return buffers;
+}
+
+std::string parallel_writer::operator()(const std::vector<column> &music) const
+{
+    std::vector<fmt::memory_buffer> buffers = format(music);
+
+    std::size_t size = open_sequence.size() + close_sequence.size();
+    for (const auto &b : buffers) {
+        size += b.size();
+    }
+    std::string lily;
+    lily.reserve(size);
+    lily += open_sequence;
+    for (const auto &b : buffers) {
+        lily.append(b.data(), b.size());
+    }
+    lily += close_sequence;
+    return lily;
+}
+
+void parallel_writer::operator()(const std::vector<column> &music, int fd) const
+{
+    std::vector<fmt::memory_buffer> buffers = format(music);
+
+    off_t offset = ::lseek(fd, 0, SEEK_CUR);
+    if (offset < 0) {
+        throw exception("cannot write the sequence: {}", std::strerror(errno));
+    }
+    write_at(fd, open_sequence, offset);
+    offset += open_sequence.size();
+
+    std::vector<std::future<void>> tasks;
+    for (const auto &b : buffers) {
+        std::string_view text(b.data(), b.size());
+        tasks.push_back(m_pool.submit([fd, text, offset] { write_at(fd, text, offset); }));
+        offset += b.size();
+    }
+    join(tasks, [](auto &t) { t.get(); });
+
+    write_at(fd, close_sequence, offset);
+    offset += close_sequence.size();
+    if (::lseek(fd, offset, SEEK_SET) < 0) {
+        throw exception("cannot write the sequence: {}", std::strerror(errno));
+    }
+}
+
+} // namespace stan::lilypond
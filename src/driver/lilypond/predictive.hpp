@@ -0,0 +1,378 @@
+#pragma once
+
+#include <stan/notation.hpp>
+#include <stan/exception.hpp>
+
+#include "scanner.hpp"
+
+#include <array>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+
+// A hand written alternative to the Spirit X3 grammar in lilypond_reader.cpp.
+// Every alternative in the LilyPond column grammar can be chosen from its
+// first byte or two ('r', '<', '[', a pitch letter, or a backslash command),
+// so this parser commits to an alternative immediately and never backtracks.
+// Keywords are matched through perfect hash tables instead of a ternary search
+// tree.  It accepts exactly the same language as the X3 grammar, including
+// whitespace between any two tokens.
+//
+// What the parser recognizes goes to a sink, in source order: a builder for
+// predictive_reader, or an event handler for event_reader.  A sink has these
+// members, called as each construct is recognized:
+//
+//     rest(value), note(value, pitch)
+//     add_pitch(pitch) for each pitch of a chord, then close_chord(value)
+//     open_beam(), then the elements, then close_beam()
+//     open_tuplet(num, den), then the elements, then close_tuplet(num, den)
+//     meter(beats, value), clef(clef::type), key(pitchclass, mode)
+
+namespace stan::lilypond {
+
+// Perfect hash table for a small, fixed set of keywords.  The hash of the
+// first two characters is collision free for every table below, so a lookup
+// is one hash, one table load, and one memcmp.  No keyword is a prefix of
+// another in the same table, so the only possible match is also the longest,
+// just like x3::symbols.
+
+template <typename T>
+class keyword_table
+{
+  public:
+    keyword_table(std::initializer_list<std::pair<const char *, T>> words)
+    {
+        for (const auto &[word, value] : words) {
+            entry &e = m_table[hash(word[0], word[1])];
+            if (e.m_word != nullptr) {
+                throw std::logic_error("keyword hash collision");
+            }
+            e = { word, std::strlen(word), value };
+        }
+    }
+
+    // On success, advance first past the keyword.
+    const T *match(const char *&first, const char *last) const
+    {
+        if (last - first < 2) {
+            return nullptr;
+        }
+
+        const entry &e = m_table[hash(first[0], first[1])];
+        if (e.m_word == nullptr or
+            static_cast<std::size_t>(last - first) < e.m_size or
+            std::memcmp(first, e.m_word, e.m_size) != 0) {
+            return nullptr;
+        }
+
+        first += e.m_size;
+        return &e.m_value;
+    }
+
+  private:
+    static std::size_t hash(char c0, char c1)
+    {
+        return (static_cast<unsigned char>(c0) + static_cast<unsigned char>(c1)) & 15u;
+    }
+
+    struct entry
+    {
+        const char *m_word = nullptr;
+        std::size_t m_size = 0;
+        T m_value{};
+    };
+
+    std::array<entry, 16> m_table;
+};
+
+enum struct command_keyword
+{
+    tuplet,
+    time,
+    clef,
+    key
+};
+
+inline const keyword_table<command_keyword> commands{
+    { "tuplet", command_keyword::tuplet },
+    { "time", command_keyword::time },
+    { "clef", command_keyword::clef },
+    { "key", command_keyword::key },
+};
+
+inline const keyword_table<clef::type> clefs{
+    { "treble", clef::type::treble },
+    { "alto", clef::type::alto },
+    { "tenor", clef::type::tenor },
+    { "bass", clef::type::bass },
+    { "percussion", clef::type::percussion },
+};
+
+inline const keyword_table<const std::vector<std::uint8_t> *> modes{
+    { "major", &mode::major },
+    { "minor", &mode::minor },
+};
+
+template <typename Sink>
+class predictive_parser
+{
+  public:
+    predictive_parser(std::string_view lily, Sink &s) :
+        m_first(lily.data()), m_last(lily.data() + lily.size()), m_sink(s) {}
+
+    void skip()
+    {
+        while (m_first != m_last and is_space(*m_first)) {
+            ++m_first;
+        }
+    }
+
+    bool done() const { return m_first == m_last; }
+
+    bool column()
+    {
+        skip();
+        if (done()) {
+            return false;
+        }
+
+        switch (*m_first) {
+        case 'r':
+            ++m_first;
+            return rest();
+        case '<':
+            ++m_first;
+            return chord();
+        case '[':
+            ++m_first;
+            return beam();
+        case '\\': {
+            ++m_first;
+            const command_keyword *c = commands.match(m_first, m_last);
+            if (c == nullptr) {
+                return false;
+            }
+            switch (*c) {
+            case command_keyword::tuplet:
+                return tuplet();
+            case command_keyword::time:
+                return meter();
+            case command_keyword::clef:
+                return clef();
+            case command_keyword::key:
+                return key();
+            }
+            return false;
+        }
+        default:
+            return note();
+        }
+    }
+
+  private:
+    bool peek(char c)
+    {
+        skip();
+        return m_first != m_last and *m_first == c;
+    }
+
+    bool expect(char c)
+    {
+        if (!peek(c)) {
+            return false;
+        }
+        ++m_first;
+        return true;
+    }
+
+    // Pitches and values are read by the same routines as the literals.
+    bool pitchclass(stan::pitchclass &pc)
+    {
+        std::optional<stan::pitchclass> p = token::pitchclass(m_first, m_last);
+        if (!p) {
+            return false;
+        }
+        pc = *p;
+        return true;
+    }
+
+    bool pitch(std::optional<stan::pitch> &p)
+    {
+        p = token::pitch(m_first, m_last);
+        return p.has_value();
+    }
+
+    bool basevalue(std::optional<stan::value> &v)
+    {
+        v = token::basevalue(m_first, m_last);
+        return v.has_value();
+    }
+
+    bool value(std::optional<stan::value> &v)
+    {
+        v = token::value(m_first, m_last);
+        return v.has_value();
+    }
+
+    // Unsigned digits, failing on overflow like x3::uint_parser.
+    template <typename T>
+    bool digits(T &n)
+    {
+        if (done() or *m_first < '0' or *m_first > '9') {
+            return false;
+        }
+
+        n = 0;
+        while (m_first != m_last and *m_first >= '0' and *m_first <= '9') {
+            T digit = *m_first++ - '0';
+            if (n > (std::numeric_limits<T>::max() - digit) / 10) {
+                return false;
+            }
+            n = n * 10 + digit;
+        }
+        return true;
+    }
+
+    // Optionally signed integer, like x3::int_.
+    bool integer(int &n)
+    {
+        skip();
+        bool negative = false;
+        if (m_first != m_last and (*m_first == '+' or *m_first == '-')) {
+            negative = *m_first++ == '-';
+        }
+
+        unsigned magnitude = 0;
+        if (!digits(magnitude) or
+            magnitude > static_cast<unsigned>(std::numeric_limits<int>::max()) + negative) {
+            return false;
+        }
+        n = negative ? static_cast<int>(0u - magnitude) : static_cast<int>(magnitude);
+        return true;
+    }
+
+    // One or more columns, followed by the closing delimiter.
+    bool elements(char close)
+    {
+        if (m_depth == max_depth) {
+            throw exception("beams and tuplets nest deeper than {} levels", max_depth);
+        }
+        ++m_depth;
+        do {
+            if (!column()) {
+                return false;
+            }
+        } while (!expect(close));
+        --m_depth;
+        return true;
+    }
+
+    bool rest()
+    {
+        std::optional<stan::value> v;
+        if (!value(v)) {
+            return false;
+        }
+        m_sink.rest(*v);
+        return true;
+    }
+
+    bool note()
+    {
+        std::optional<stan::pitch> p;
+        std::optional<stan::value> v;
+        if (!pitch(p) or !value(v)) {
+            return false;
+        }
+        m_sink.note(*v, *p);
+        return true;
+    }
+
+    bool chord()
+    {
+        std::optional<stan::pitch> p;
+        if (!pitch(p)) {
+            return false;
+        }
+        do {
+            m_sink.add_pitch(*p);
+        } while (pitch(p));
+
+        std::optional<stan::value> v;
+        if (!expect('>') or !value(v)) {
+            return false;
+        }
+        m_sink.close_chord(*v);
+        return true;
+    }
+
+    bool beam()
+    {
+        m_sink.open_beam();
+        if (!elements(']')) {
+            return false;
+        }
+        m_sink.close_beam();
+        return true;
+    }
+
+    bool tuplet()
+    {
+        int num = 0;
+        int den = 0;
+        if (!integer(num) or !expect('/') or !integer(den) or !expect('{')) {
+            return false;
+        }
+        m_sink.open_tuplet(num, den);
+        if (!elements('}')) {
+            return false;
+        }
+        m_sink.close_tuplet(num, den);
+        return true;
+    }
+
+    bool meter()
+    {
+        std::uint16_t beats = 0;
+        std::optional<stan::value> v;
+        skip();
+        if (!digits(beats) or !expect('/') or !basevalue(v)) {
+            return false;
+        }
+        m_sink.meter(static_cast<std::uint8_t>(beats), *v);
+        return true;
+    }
+
+    bool clef()
+    {
+        skip();
+        const clef::type *t = clefs.match(m_first, m_last);
+        if (t == nullptr) {
+            return false;
+        }
+        m_sink.clef(*t);
+        return true;
+    }
+
+    bool key()
+    {
+        stan::pitchclass tonic;
+        if (!pitchclass(tonic) or !expect('\\')) {
+            return false;
+        }
+        const auto *const *m = modes.match(m_first, m_last);
+        if (m == nullptr) {
+            return false;
+        }
+        m_sink.key(tonic, **m);
+        return true;
+    }
+
+    const char *m_first;
+    const char *m_last;
+    Sink &m_sink;
+    std::size_t m_depth = 0;
+};
+
+} // namespace stan::lilypond
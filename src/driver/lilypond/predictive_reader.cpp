@@ -0,0 +1,64 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+
+#include "builder.hpp"
+#include "predictive.hpp"
+
+#include <stdexcept>
+
+namespace stan::lilypond {
+
+namespace {
+
+// Builds the same objects through the same builder as the X3 grammar.
+struct builder_sink
+{
+    void rest(const value &v) { m_builder.emplace<stan::rest>(v); }
+    void note(const value &v, const pitch &p) { m_builder.emplace<stan::note>(v, p); }
+    void add_pitch(const pitch &p) { m_builder.add_pitch(p); }
+    void close_chord(const value &v) { m_builder.close_chord(v); }
+    void open_beam() { m_builder.open(); }
+    void close_beam() { m_builder.close_beam(); }
+    void open_tuplet(int, int) { m_builder.open(); }
+    void close_tuplet(int num, int den) { m_builder.close_tuplet(num, den); }
+    void meter(std::uint8_t beats, const value &v) { m_builder.emplace_meter(beats, v); }
+    void clef(clef::type t) { m_builder.emplace<stan::clef>(t); }
+
+    void key(pitchclass tonic, const std::vector<std::uint8_t> &mode)
+    {
+        m_builder.emplace_key(tonic, mode);
+    }
+
+    builder &m_builder;
+};
+
+} // namespace
+
+predictive_reader::predictive_reader() :
+    m_builder(std::make_unique<builder>())
+{
+}
+
+predictive_reader::predictive_reader(predictive_reader &&) noexcept = default;
+predictive_reader &predictive_reader::operator=(predictive_reader &&) noexcept = default;
+predictive_reader::~predictive_reader() = default;
+
+stan::column predictive_reader::operator()(std::string_view lily)
+{
+    m_builder->clear();
+    builder_sink sink{ *m_builder };
+    predictive_parser<builder_sink> p(lily, sink);
+
+    if (!p.column()) {
+        throw std::runtime_error("parse error");
+    }
+
+    p.skip();
+    if (!p.done()) {
+        throw std::runtime_error("incomplete parse");
+    }
+
+    return m_builder->pop();
+}
+
+} // namespace stan::lilypond
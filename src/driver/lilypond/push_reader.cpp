@@ -0,0 +1,177 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+
+#include "scanner.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+namespace stan::lilypond {
+
+// The body of the sequence, after its opening brace, goes through a boundary
+// scanner, whose offsets count from the first byte of the body.  The text of
+// the column that began at m_start, up to the start of the current piece, is
+// kept in m_pending.  A column that lies entirely within one piece is parsed
+// straight from that piece without being copied.
+//
+// The first bracket the scanner sees closed but not opened has to be the
+// closing brace of the sequence, and only whitespace may follow it.  Either
+// error is thrown from the piece it is in, so that nothing after it is
+// buffered.
+
+struct push_reader::state
+{
+    explicit state(handler h) :
+        m_handler(std::move(h)) {}
+
+    void feed(std::string_view lily)
+    {
+        if (!m_opened) {
+            while (!lily.empty() and is_space(lily.front())) {
+                lily.remove_prefix(1);
+            }
+            if (lily.empty()) {
+                return;
+            }
+            if (lily.front() != '{') {
+                throw std::runtime_error("parse error");
+            }
+            lily.remove_prefix(1);
+            m_opened = true;
+        }
+        if (m_closed) {
+            expect_blank(lily);
+            return;
+        }
+
+        std::size_t base = m_scanner.offset();
+        m_scanner.scan(lily, [this, lily, base](std::size_t boundary) {
+            complete(lily, base, boundary);
+        });
+        if (const auto &unopened = m_scanner.unopened()) {
+            auto [bracket, offset] = *unopened;
+            if (bracket != '}') {
+                throw std::runtime_error("parse error");
+            }
+            expect_blank(lily.substr(offset - base + 1));
+            m_closed = true;
+        }
+
+        if (m_start >= base) {
+            m_pending.assign(lily.substr(m_start - base));
+        } else {
+            m_pending.append(lily);
+        }
+    }
+
+    void finish()
+    {
+        if (!m_opened) {
+            throw std::runtime_error("parse error");
+        }
+
+        std::size_t base = m_scanner.offset();
+        m_scanner.finish([this, base](std::size_t boundary) {
+            complete({}, base, boundary);
+        });
+
+        if (!m_closed) {
+            throw std::runtime_error("parse error");
+        }
+
+        // What is left is the last column, if any, and the closing brace.
+        std::string_view tail = m_pending;
+        while (is_space(tail.back())) {
+            tail.remove_suffix(1);
+        }
+        tail.remove_suffix(1);
+        parse(tail);
+        m_pending.clear();
+    }
+
+  private:
+    // Anything after the closing brace is left over, as for reader.
+    static void expect_blank(std::string_view lily)
+    {
+        for (char c : lily) {
+            if (!is_space(c)) {
+                throw std::runtime_error("incomplete parse");
+            }
+        }
+    }
+
+    // The column that began at m_start ends at boundary.  The current piece,
+    // lily, begins at base.  The scanner may only decide about a token some
+    // way into it, so the boundary can be before base when a piece splits the
+    // token.
+    void complete(std::string_view lily, std::size_t base, std::size_t boundary)
+    {
+        if (m_start >= base) {
+            parse(lily.substr(m_start - base, boundary - m_start));
+        } else if (boundary <= base) {
+            parse(std::string_view(m_pending).substr(0, boundary - m_start));
+            m_pending.erase(0, boundary - m_start);
+        } else {
+            m_pending.append(lily.substr(0, boundary - base));
+            parse(m_pending);
+            m_pending.clear();
+        }
+        m_start = boundary;
+    }
+
+    // The scanner only finds boundaries after whitespace, so the text between
+    // two of them may hold several columns, as in "d4[e8 f8]".  As from
+    // sequence_reader, the columns before a malformed one are handed over
+    // before it throws.
+    void parse(std::string_view lily)
+    {
+        m_columns.clear();
+        try {
+            m_reader.append(lily, m_columns);
+        } catch (...) {
+            hand_over();
+            throw;
+        }
+        hand_over();
+    }
+
+    void hand_over()
+    {
+        for (auto &c : m_columns) {
+            m_handler(std::move(c));
+        }
+        m_columns.clear();
+    }
+
+    handler m_handler;
+    reader m_reader;
+    boundary_scanner m_scanner;
+    bool m_opened = false;
+    bool m_closed = false;
+    std::size_t m_start = 0;
+    std::string m_pending;
+
+    // The columns of the text being parsed, reused from one to the next.
+    std::vector<column> m_columns;
+};
+
+push_reader::push_reader(handler h) :
+    m_state(std::make_unique<state>(std::move(h)))
+{
+}
+
+push_reader::push_reader(push_reader &&) noexcept = default;
+push_reader &push_reader::operator=(push_reader &&) noexcept = default;
+push_reader::~push_reader() = default;
+
+void push_reader::feed(std::string_view lily)
+{
+    m_state->feed(lily);
+}
+
+void push_reader::finish()
+{
+    m_state->finish();
+}
+
+} // namespace stan::lilypond
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stan/driver/lilypond.hpp>
+
+#include <functional>
+
+namespace stan::lilypond {
+
+// The loop behind reader::recover, for readers that also need to know where
+// each column is.  item is called once per column or error, in order, with
+// the byte range [first, last) that it covers.  The range of an error extends
+// to the next column boundary, where parsing resumed.  Every pair of brackets
+// that match lies within one range, and every bracket that does not lies
+// within the range of an error.
+
+using recover_item = std::function<void(std::size_t first, std::size_t last, result<column> &&)>;
+
+void recover_columns(std::string_view lily, builder &b, const recover_item &item);
+
+} // namespace stan::lilypond
@@ -0,0 +1,313 @@
+#pragma once
+
+#include <stan/driver/lilypond/tokens.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace stan::lilypond {
+
+// Beams and tuplets nest, and both backends parse them by recursion, as
+// variable_reader does repeats, so the nesting is limited to keep the stack
+// from overflowing on hostile input.
+inline constexpr std::size_t max_depth = 1000;
+
+// Same whitespace as x3::space.
+using token::is_space;
+
+// The boundary scanner finds places where a top level column begins, without
+// parsing anything.  It runs at close to memory bandwidth, so it can be used
+// to split a sequence into pieces that are then parsed independently.
+//
+// Only boundaries that are preceded by whitespace are reported, which is
+// every boundary in anything the writer produces.  Nesting depth is tracked
+// across '[' ']', '{' '}' and '<' '>', and a boundary is reported only at
+// depth zero, before a token that can only begin a column: '[', '<', 'r', a
+// pitch (unless it is the argument of a preceding \key or \clef), or one of
+// the commands \tuplet, \time, \clef or \key.
+//
+// The scanner is resumable: input can be fed in pieces of any size, even
+// splitting a token, and offsets are reported relative to the very first
+// byte ever fed.
+
+class boundary_scanner
+{
+  public:
+    template <typename Boundary>
+    void scan(std::string_view lily, Boundary &&boundary)
+    {
+        for (char c : lily) {
+            if (is_space(c)) {
+                if (m_in_token) {
+                    finish_token(boundary);
+                }
+            } else {
+                if (!m_in_token) {
+                    m_in_token = true;
+                    m_decided = false;
+                    m_token_start = m_offset;
+                    m_token_depth = m_depth;
+                    m_prefix_size = 0;
+                }
+
+                if (m_prefix_size < sizeof(m_prefix)) {
+                    m_prefix[m_prefix_size++] = c;
+                }
+                if (!m_decided) {
+                    decide(false, boundary);
+                }
+
+                switch (c) {
+                case '[':
+                case '{':
+                case '<':
+                    ++m_depth;
+                    break;
+                case ']':
+                case '}':
+                case '>':
+                    if (--m_depth < 0 and !m_unopened) {
+                        m_unopened.emplace(c, m_offset);
+                    }
+                    break;
+                default:
+                    break;
+                }
+            }
+            ++m_offset;
+        }
+    }
+
+    // Decide about a token that was cut off by the end of the input.
+    template <typename Boundary>
+    void finish(Boundary &&boundary)
+    {
+        if (m_in_token) {
+            finish_token(boundary);
+        }
+    }
+
+    int depth() const { return m_depth; }
+    std::size_t offset() const { return m_offset; }
+
+    // The first bracket that closed one that was never opened, and its
+    // offset, if there has been one.
+    const std::optional<std::pair<char, std::size_t>> &unopened() const { return m_unopened; }
+
+  private:
+    template <typename Boundary>
+    void finish_token(Boundary &boundary)
+    {
+        if (!m_decided) {
+            decide(true, boundary);
+        }
+        m_in_token = false;
+        m_after_command = m_token_depth == 0 and
+            (starts_with(R"(\key)") or starts_with(R"(\clef)"));
+    }
+
+    // Decide whether the current token begins a column, as soon as enough of
+    // its prefix is known.
+    template <typename Boundary>
+    void decide(bool complete, Boundary &boundary)
+    {
+        static const char *const commands[] = { R"(\tuplet)", R"(\time)", R"(\clef)", R"(\key)" };
+
+        bool begins = false;
+        char c = m_prefix[0];
+        if (m_token_depth != 0) {
+            begins = false;
+        } else if (c == '[' or c == '<' or c == 'r') {
+            begins = true;
+        } else if (c >= 'a' and c <= 'g') {
+            begins = !m_after_command;
+        } else if (c == '\\') {
+            bool undecided = false;
+            for (const char *command : commands) {
+                if (starts_with(command)) {
+                    begins = true;
+                } else if (!complete and m_prefix_size < std::strlen(command) and
+                           std::strncmp(command, m_prefix, m_prefix_size) == 0) {
+                    undecided = true;
+                }
+            }
+            if (!begins and undecided) {
+                return;
+            }
+        }
+
+        m_decided = true;
+        if (begins) {
+            boundary(m_token_start);
+        }
+    }
+
+    bool starts_with(const char *word) const
+    {
+        std::size_t size = std::strlen(word);
+        return m_prefix_size >= size and std::strncmp(word, m_prefix, size) == 0;
+    }
+
+    std::size_t m_offset = 0;
+    int m_depth = 0;
+    std::optional<std::pair<char, std::size_t>> m_unopened;
+
+    bool m_in_token = false;
+    bool m_decided = false;
+    bool m_after_command = false;
+    std::size_t m_token_start = 0;
+    int m_token_depth = 0;
+    char m_prefix[8] = {};
+    std::size_t m_prefix_size = 0;
+};
+
+// Offset of the first top level column boundary after the column that begins
+// at lily[start], or lily.size() if there is none, reading each of the
+// brackets at the offsets [unmatched, unmatched_last), which are in order, as
+// whitespace.  The input is scanned in small blocks so that the scan stops
+// soon after the boundary.
+template <typename Iterator>
+std::size_t next_boundary(std::string_view lily, std::size_t start, Iterator unmatched,
+                          Iterator unmatched_last)
+{
+    constexpr std::size_t block = 256;
+
+    boundary_scanner scanner;
+    std::optional<std::size_t> next;
+    auto boundary = [&next](std::size_t offset) {
+        if (offset > 0 and !next) {
+            next = offset;
+        }
+    };
+    for (std::size_t i = start; i < lily.size() and !next;) {
+        while (unmatched != unmatched_last and *unmatched < i) {
+            ++unmatched;
+        }
+        if (unmatched != unmatched_last and *unmatched == i) {
+            scanner.scan(" ", boundary);
+            ++i;
+            continue;
+        }
+        std::size_t stop = std::min(i + block, lily.size());
+        if (unmatched != unmatched_last) {
+            stop = std::min<std::size_t>(stop, *unmatched);
+        }
+        scanner.scan(lily.substr(i, stop - i), boundary);
+        i = stop;
+    }
+    return start + next.value_or(lily.size() - start);
+}
+
+// Offsets of the brackets in lily that close nothing, or that nothing closes,
+// in order.  As for count_unmatched(), any closing bracket closes any opening
+// one, so the closing brackets among them all come before the opening ones.
+inline std::vector<std::size_t> unmatched_brackets(std::string_view lily)
+{
+    std::vector<std::size_t> unmatched;
+    std::vector<std::size_t> open;
+    for (std::size_t i = 0; i < lily.size(); ++i) {
+        char c = lily[i];
+        if (c == '[' or c == '{' or c == '<') {
+            open.push_back(i);
+        } else if (c == ']' or c == '}' or c == '>') {
+            if (open.empty()) {
+                unmatched.push_back(i);
+            } else {
+                open.pop_back();
+            }
+        }
+    }
+    unmatched.insert(unmatched.end(), open.begin(), open.end());
+    return unmatched;
+}
+
+// How many of the brackets in lily close nothing there, and how many nothing
+// there closes; lily is balanced if both are zero.  Like the boundary
+// scanner, this does not distinguish one kind of bracket from another.
+struct unmatched_count
+{
+    std::size_t m_closing = 0;
+    std::size_t m_opening = 0;
+};
+
+inline unmatched_count count_unmatched(std::string_view lily)
+{
+    unmatched_count count;
+    for (char c : lily) {
+        if (c == '[' or c == '{' or c == '<') {
+            ++count.m_opening;
+        } else if (c == ']' or c == '}' or c == '>') {
+            if (count.m_opening > 0) {
+                --count.m_opening;
+            } else {
+                ++count.m_closing;
+            }
+        }
+    }
+    return count;
+}
+
+// The bracket that closes each opening bracket of lily, as (open, close)
+// offsets in the order they open, with a close of lily.size() for one that is
+// never closed.  One pass finds them all, where closing_bracket() scans the
+// body of each.  As for count_unmatched(), any closing bracket closes any
+// opening one.
+inline std::vector<std::pair<std::size_t, std::size_t>> bracket_pairs(std::string_view lily)
+{
+    std::vector<std::pair<std::size_t, std::size_t>> pairs;
+    std::vector<std::size_t> open;
+    for (std::size_t i = 0; i < lily.size(); ++i) {
+        char c = lily[i];
+        if (c == '[' or c == '{' or c == '<') {
+            open.push_back(pairs.size());
+            pairs.emplace_back(i, lily.size());
+        } else if ((c == ']' or c == '}' or c == '>') and !open.empty()) {
+            pairs[open.back()].second = i;
+            open.pop_back();
+        }
+    }
+    return pairs;
+}
+
+// Offset of the bracket that closes the one at lily[open], which must be an
+// opening bracket, or an empty optional if it is never closed.  As for
+// count_unmatched(), any closing bracket closes any opening one.
+inline std::optional<std::size_t> closing_bracket(std::string_view lily, std::size_t open)
+{
+    int depth = 0;
+    for (std::size_t i = open; i < lily.size(); ++i) {
+        char c = lily[i];
+        if (c == '[' or c == '{' or c == '<') {
+            ++depth;
+        } else if ((c == ']' or c == '}' or c == '>') and --depth == 0) {
+            return i;
+        }
+    }
+    return std::nullopt;
+}
+
+// The characters between the outer braces of a sequence, "{ ... }", or an
+// empty optional if lily is not a brace enclosed sequence.
+inline std::optional<std::string_view> sequence_body(std::string_view lily)
+{
+    std::size_t open = 0;
+    while (open < lily.size() and is_space(lily[open])) {
+        ++open;
+    }
+    std::size_t close = lily.size();
+    while (close > open and is_space(lily[close - 1])) {
+        --close;
+    }
+
+    if (close - open < 2 or lily[open] != '{' or lily[close - 1] != '}') {
+        return std::nullopt;
+    }
+    return lily.substr(open + 1, close - open - 2);
+}
+
+} // namespace stan::lilypond
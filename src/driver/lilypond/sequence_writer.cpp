@@ -0,0 +1,146 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include <stan/exception.hpp>
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <ostream>
+
+namespace stan::lilypond {
+
+namespace {
+
+// writev() may write less than it was given, and start over in the middle of
+// any of the pieces.
+void write_all(int fd, iovec *pieces, int count)
+{
+    while (count > 0) {
+        ssize_t written = ::writev(fd, pieces, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw exception("cannot write the sequence: {}", std::strerror(errno));
+        }
+
+        auto n = static_cast<std::size_t>(written);
+        while (count > 0 and n >= pieces->iov_len) {
+            n -= pieces->iov_len;
+            ++pieces;
+            --count;
+        }
+        if (count > 0) {
+            pieces->iov_base = static_cast<char *>(pieces->iov_base) + n;
+            pieces->iov_len -= n;
+        }
+    }
+}
+
+} // namespace
+
+sequence_writer::sequence_writer(int fd) :
+    m_fd(fd)
+{
+    for (auto &b : m_buffers) {
+        b.reset(new char[buffer_size]);
+    }
+    put("{ ");
+}
+
+sequence_writer::sequence_writer(std::ostream &stream) :
+    m_stream(&stream)
+{
+    for (auto &b : m_buffers) {
+        b.reset(new char[buffer_size]);
+    }
+    put("{ ");
+}
+
+sequence_writer::~sequence_writer() = default;
+
+void sequence_writer::operator()(const column &c)
+{
+    m_column.clear();
+    writer().write_to(m_column, c);
+    m_column.push_back(' ');
+    put({ m_column.data(), m_column.size() });
+}
+
+void sequence_writer::append(std::string_view lily)
+{
+    put(lily);
+}
+
+void sequence_writer::finish()
+{
+    put("}\n");
+    flush({});
+    if (m_stream != nullptr and !m_stream->flush()) {
+        throw exception("cannot write the sequence");
+    }
+}
+
+// Copy text into the buffers, and write them all out once they are full.  Text
+// as large as a buffer is written out right away, behind what is buffered.
+void sequence_writer::put(std::string_view text)
+{
+    if (text.size() < buffer_size - m_used) {
+        std::memcpy(m_buffers[m_buffer].get() + m_used, text.data(), text.size());
+        m_used += text.size();
+        return;
+    }
+    if (text.size() >= buffer_size) {
+        flush(text);
+        return;
+    }
+
+    while (!text.empty()) {
+        std::size_t n = std::min(text.size(), buffer_size - m_used);
+        std::memcpy(m_buffers[m_buffer].get() + m_used, text.data(), n);
+        m_used += n;
+        text.remove_prefix(n);
+
+        if (m_used == buffer_size) {
+            m_used = 0;
+            if (++m_buffer == buffer_count) {
+                flush({});
+            }
+        }
+    }
+}
+
+// Write out the full buffers, the part of the current one that is used, and
+// then the tail.
+void sequence_writer::flush(std::string_view tail)
+{
+    std::array<iovec, buffer_count + 1> pieces;
+    int count = 0;
+    for (std::size_t b = 0; b < m_buffer; ++b) {
+        pieces[count++] = { m_buffers[b].get(), buffer_size };
+    }
+    if (m_used != 0) {
+        pieces[count++] = { m_buffers[m_buffer].get(), m_used };
+    }
+    if (!tail.empty()) {
+        pieces[count++] = { const_cast<char *>(tail.data()), tail.size() };
+    }
+    m_buffer = 0;
+    m_used = 0;
+
+    if (m_stream == nullptr) {
+        write_all(m_fd, pieces.data(), count);
+        return;
+    }
+    for (int i = 0; i < count; ++i) {
+        m_stream->write(static_cast<const char *>(pieces[i].iov_base),
+                        static_cast<std::streamsize>(pieces[i].iov_len));
+    }
+    if (!*m_stream) {
+        throw exception("cannot write the sequence");
+    }
+}
+
+} // namespace stan::lilypond
@@ -0,0 +1,112 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include <stan/thread_pool.hpp>
+
+#include "scanner.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <stdexcept>
+
+namespace stan::lilypond {
+
+namespace {
+
+void skip(std::string_view lily, std::size_t &i)
+{
+    while (i < lily.size() and is_space(lily[i])) {
+        ++i;
+    }
+}
+
+bool starts_with(std::string_view lily, std::size_t i, std::string_view word)
+{
+    return lily.substr(i, word.size()) == word;
+}
+
+} // namespace
+
+simultaneous_reader::simultaneous_reader(thread_pool &pool) :
+    m_pool(pool)
+{
+}
+
+simultaneous_music simultaneous_reader::operator()(std::string_view lily)
+{
+    std::size_t i = 0;
+    skip(lily, i);
+    if (!starts_with(lily, i, "<<")) {
+        throw std::runtime_error("parse error");
+    }
+    i += 2;
+
+    // Find the body of every voice first, which is cheap, and then parse them
+    // all at once.
+    std::vector<std::string_view> bodies;
+    for (;;) {
+        skip(lily, i);
+        if (i == lily.size()) {
+            throw std::runtime_error("parse error");
+        }
+        if (starts_with(lily, i, ">>")) {
+            break;
+        }
+
+        std::optional<std::size_t> close;
+        if (lily[i] == '{') {
+            close = closing_bracket(lily, i);
+        }
+        if (!close or lily[*close] != '}') {
+            throw std::runtime_error("parse error");
+        }
+
+        bodies.push_back(lily.substr(i + 1, *close - i - 1));
+        i = *close + 1;
+    }
+
+    i += 2;
+    skip(lily, i);
+    bool complete = i == lily.size();
+
+    // Each task keeps one reader for all the voices it takes, and takes the
+    // next voice that no other has.  A failed voice is recorded and skipped,
+    // so that the error reported is the one for the first failed voice.
+    simultaneous_music music;
+    music.m_voices.resize(bodies.size());
+    std::vector<std::exception_ptr> errors(bodies.size());
+    std::atomic<std::size_t> next{ 0 };
+
+    std::vector<std::future<void>> tasks;
+    for (std::size_t t = 0; t < std::min(m_pool.size(), bodies.size()); ++t) {
+        tasks.push_back(m_pool.submit([&bodies, &music, &errors, &next] {
+            reader read;
+            for (;;) {
+                std::size_t v = next.fetch_add(1, std::memory_order_relaxed);
+                if (v >= bodies.size()) {
+                    return;
+                }
+                try {
+                    read.append(bodies[v], music.m_voices[v]);
+                } catch (...) {
+                    errors[v] = std::current_exception();
+                }
+            }
+        }));
+    }
+    for (auto &t : tasks) {
+        t.get();
+    }
+
+    for (const auto &error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    if (!complete) {
+        throw std::runtime_error("incomplete parse");
+    }
+    return music;
+}
+
+} // namespace stan::lilypond
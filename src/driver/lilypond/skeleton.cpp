@@ -0,0 +1,295 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include <stan/exception.hpp>
+
+#include "scanner.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+namespace stan::lilypond {
+
+namespace {
+
+enum struct byte_class : std::uint8_t
+{
+    ordinary,
+    space,
+    opening,
+    closing
+};
+
+// What a column that begins with a given byte is, if it is one at all.  A
+// backslash may begin any of the commands, which are told apart by name.
+constexpr std::uint8_t no_column = 0xff;
+constexpr std::uint8_t command = 0xfe;
+
+struct byte_info
+{
+    byte_class m_class = byte_class::ordinary;
+    std::uint8_t m_column = no_column;
+};
+
+constexpr std::array<byte_info, 256> classify()
+{
+    using kind = skeleton::kind;
+
+    std::array<byte_info, 256> table{};
+    for (int c = 0; c < 256; ++c) {
+        if (is_space(static_cast<char>(c))) {
+            table[c].m_class = byte_class::space;
+        }
+    }
+    for (char c : { '[', '{', '<' }) {
+        table[c].m_class = byte_class::opening;
+    }
+    for (char c : { ']', '}', '>' }) {
+        table[c].m_class = byte_class::closing;
+    }
+    for (char c = 'a'; c <= 'g'; ++c) {
+        table[c].m_column = static_cast<std::uint8_t>(kind::note);
+    }
+    table['r'].m_column = static_cast<std::uint8_t>(kind::rest);
+    table['<'].m_column = static_cast<std::uint8_t>(kind::chord);
+    table['['].m_column = static_cast<std::uint8_t>(kind::beam);
+    table['\\'].m_column = command;
+    return table;
+}
+
+constexpr std::array<byte_info, 256> bytes = classify();
+
+const byte_info &info(char c)
+{
+    return bytes[static_cast<unsigned char>(c)];
+}
+
+bool starts_with(const char *first, const char *last, std::string_view word)
+{
+    return static_cast<std::size_t>(last - first) >= word.size() and
+        std::memcmp(first, word.data(), word.size()) == 0;
+}
+
+// The state of the scan, which is a single pass over the body of the sequence
+// that handles one token at a time.  The bytes inside a token are skipped
+// with a table lookup each, unless they are brackets.
+
+class scanner
+{
+  public:
+    using kind = skeleton::kind;
+    using node = skeleton::node;
+
+    scanner(const char *data, std::vector<node> &nodes, std::vector<std::uint32_t> &columns) :
+        m_data(data), m_nodes(nodes), m_columns(columns) {}
+
+    void scan(const char *p, const char *last)
+    {
+        while (p != last) {
+            if (info(*p).m_class == byte_class::space) {
+                ++p;
+                continue;
+            }
+
+            const char *token = p;
+            if (m_depth == m_level) {
+                column(p, last);
+            }
+
+            // The rest of the token.  A bracket that opens or closes a
+            // container also ends the token.
+            for (;;) {
+                if (p == last) {
+                    m_end = offset(p);
+                    break;
+                }
+
+                const byte_info &b = info(*p);
+                if (b.m_column != no_column and p != token and m_depth == m_level) {
+                    check_space(p);
+                }
+                if (b.m_class == byte_class::ordinary) {
+                    ++p;
+                } else if (b.m_class == byte_class::space) {
+                    m_end = offset(p);
+                    break;
+                } else if (b.m_class == byte_class::opening) {
+                    ++p;
+                    if (++m_depth == m_level + 1 and m_pending != none and *(p - 1) != '<') {
+                        open();
+                        break;
+                    }
+                } else {
+                    if (--m_depth < 0) {
+                        throw std::runtime_error("parse error");
+                    }
+                    if (m_depth < m_level) {
+                        if (p != token) {
+                            m_end = offset(p);
+                        }
+                        close(offset(p) + 1);
+                        ++p;
+                        break;
+                    }
+                    ++p;
+                }
+            }
+        }
+
+        end_leaf();
+        if (m_depth != 0 or !m_open.empty()) {
+            throw std::runtime_error("parse error");
+        }
+    }
+
+  private:
+    static constexpr std::uint32_t none = 0xffffffff;
+
+    // A beam or tuplet whose elements are being scanned.
+    struct container
+    {
+        std::uint32_t m_node;
+
+        // Bracket depth of the elements; the bracket that brings the depth
+        // below this closes the container.
+        int m_depth;
+    };
+
+    std::size_t offset(const char *p) const { return p - m_data; }
+
+    // A column may begin inside a token at p, as the "f" of "bf4f''32" does.
+    // Every note, rest and chord ends with a duration, and nothing else
+    // continues one, so a column that follows a digit or a dot begins there.
+    void check_space(const char *p) const
+    {
+        char c = *(p - 1);
+        if ((c >= '0' and c <= '9') or c == '.') {
+            throw exception("no space before the column at byte {}", offset(p));
+        }
+    }
+
+    // A token begins at p, at the nesting level of the current container's
+    // elements.
+    void column(const char *p, const char *last)
+    {
+        if (m_argument) {
+            m_argument = false;
+            return;
+        }
+
+        std::uint8_t k = info(*p).m_column;
+        if (k == no_column) {
+            return;
+        }
+        if (k == command) {
+            using namespace std::string_view_literals;
+            if (starts_with(p, last, R"(\tuplet)"sv)) {
+                k = static_cast<std::uint8_t>(kind::tuplet);
+            } else if (starts_with(p, last, R"(\time)"sv)) {
+                k = static_cast<std::uint8_t>(kind::meter);
+            } else if (starts_with(p, last, R"(\clef)"sv)) {
+                k = static_cast<std::uint8_t>(kind::clef);
+                m_argument = true;
+            } else if (starts_with(p, last, R"(\key)"sv)) {
+                k = static_cast<std::uint8_t>(kind::key);
+                m_argument = true;
+            } else {
+                return;
+            }
+        }
+
+        end_leaf();
+        auto index = static_cast<std::uint32_t>(m_nodes.size());
+        if (m_open.empty()) {
+            m_columns.push_back(index);
+        }
+        std::size_t first = offset(p);
+        m_nodes.push_back({ first, first + 1, static_cast<kind>(k), 1 });
+
+        if (k == static_cast<std::uint8_t>(kind::beam) or
+            k == static_cast<std::uint8_t>(kind::tuplet)) {
+            m_pending = index;
+        } else {
+            m_leaf = index;
+        }
+    }
+
+    void end_leaf()
+    {
+        if (m_leaf != none) {
+            m_nodes[m_leaf].m_last = m_end;
+            m_leaf = none;
+        }
+    }
+
+    // The opening bracket of the pending container was just passed.
+    void open()
+    {
+        m_open.push_back({ m_pending, m_depth });
+        m_level = m_depth;
+        m_pending = none;
+    }
+
+    // The closing bracket of the innermost container ends just before last.
+    void close(std::size_t last)
+    {
+        end_leaf();
+        node &n = m_nodes[m_open.back().m_node];
+        n.m_last = last;
+        n.m_size = static_cast<std::uint32_t>(m_nodes.size() - m_open.back().m_node);
+        m_open.pop_back();
+        m_level = m_open.empty() ? 0 : m_open.back().m_depth;
+    }
+
+    const char *m_data;
+    std::vector<node> &m_nodes;
+    std::vector<std::uint32_t> &m_columns;
+
+    std::vector<container> m_open;
+    int m_depth = 0;
+
+    // Bracket depth of the columns currently being scanned.
+    int m_level = 0;
+
+    // The leaf column being scanned, and one past the last byte of its last
+    // complete token.
+    std::uint32_t m_leaf = none;
+    std::size_t m_end = 0;
+
+    // The beam or tuplet whose opening bracket has not been seen yet.
+    std::uint32_t m_pending = none;
+
+    // Whether the next token is the argument of \key or \clef rather than a
+    // column.
+    bool m_argument = false;
+};
+
+} // namespace
+
+skeleton::skeleton(std::string_view lily) :
+    m_text(lily)
+{
+    std::optional<std::string_view> body = sequence_body(lily);
+    if (!body) {
+        throw std::runtime_error("parse error");
+    }
+    // Every column but the first of a container follows a space, so this is
+    // close to the number of nodes.  Counting is much cheaper than growing
+    // the vector from nothing.
+    m_nodes.reserve(std::count(body->begin(), body->end(), ' ') + 1);
+
+    scanner(lily.data(), m_nodes, m_columns).scan(body->data(), body->data() + body->size());
+}
+
+std::vector<column> skeleton::build(std::size_t first, std::size_t last, reader &read) const
+{
+    std::vector<column> music;
+    music.reserve(last - first);
+    for (std::size_t i = first; i < last; ++i) {
+        music.push_back(build((*this)[i], read));
+    }
+    return music;
+}
+
+} // namespace stan::lilypond
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <stan/notation.hpp>
+
+#include "scanner.hpp"
+
+#include <array>
+#include <bitset>
+#include <new>
+#include <optional>
+
+namespace stan::lilypond {
+
+// Checks each construct as the predictive parser recognizes it, with the same
+// rules as the notation model, but keeps only what those rules need: for each
+// open beam or tuplet, the number and total duration of its elements so far,
+// and whether it holds anything a beam cannot.  The first broken rule makes
+// the whole input invalid, and the rest of it is only parsed.  event_reader
+// runs one beside its own sink, and throws as soon as it turns invalid.
+class validating_sink
+{
+  public:
+    validating_sink() { m_frames[0].open(); }
+
+    void rest(const value &v) { add(kind::rest, v, length(v)); }
+    void note(const value &v, const pitch &) { add(kind::note, v, length(v)); }
+
+    // Pitches are unique by pitchclass and octave.
+    void add_pitch(const pitch &p)
+    {
+        std::size_t i = static_cast<std::uint8_t>(p.m_pitchclass) * 8u +
+            static_cast<std::uint8_t>(p.m_octave);
+        m_valid = m_valid and !m_pitches.test(i);
+        m_pitches.set(i);
+        ++m_size;
+    }
+
+    void close_chord(const value &v)
+    {
+        m_valid = m_valid and m_size >= 2;
+        m_pitches.reset();
+        m_size = 0;
+        add(kind::chord, v, length(v));
+    }
+
+    void open_beam() { m_frames[++m_depth].open(); }
+
+    // See beam::validate.
+    void close_beam()
+    {
+        const frame &f = m_frames[m_depth--];
+        m_valid = m_valid and !f.m_invalid and (!f.m_pairs or f.m_size >= 2);
+        add(kind::beam, value::instantaneous(), f.m_duration);
+    }
+
+    void open_tuplet(int, int)
+    {
+        m_frames[++m_depth].open();
+        ++m_tuplets;
+    }
+
+    // See tuplet::scale and tuplet::validate.
+    void close_tuplet(int num, int den)
+    {
+        const frame &f = m_frames[m_depth--];
+        --m_tuplets;
+        std::optional<value> v = tuplet::fit(num, den, f.m_duration);
+        m_valid = m_valid and v and f.m_size >= 2;
+        value outer = v.value_or(value::instantaneous());
+        add(kind::tuplet, outer, length(outer));
+    }
+
+    // See meter::validate.
+    void meter(std::uint8_t, const value &v)
+    {
+        m_valid = m_valid and (v == value::half() or v == value::quarter() or
+                               v == value::eighth() or v == value::sixteenth() or
+                               v == value::thirtysecond());
+        add(kind::change, value::instantaneous(), duration::zero());
+    }
+
+    void clef(clef::type) { add(kind::change, value::instantaneous(), duration::zero()); }
+
+    void key(pitchclass, const std::vector<std::uint8_t> &)
+    {
+        add(kind::change, value::instantaneous(), duration::zero());
+    }
+
+    bool valid() const { return m_valid; }
+
+  private:
+    enum struct kind
+    {
+        rest,
+        note,
+        chord,
+        beam,
+        tuplet,
+        change
+    };
+
+    // Frames are only initialized as they are opened, so that a short input
+    // does not pay to initialize all of them.  A duration has no default
+    // constructor, hence the union.
+    struct frame
+    {
+        frame() {}
+
+        void open()
+        {
+            ::new (&m_duration) duration(duration::zero());
+            m_size = 0;
+            m_invalid = false;
+            m_pairs = false;
+        }
+
+        union
+        {
+            duration m_duration;
+        };
+        std::uint32_t m_size;
+
+        // For a beam: whether it holds a rest, a change, or anything longer
+        // than a quarter, and whether it holds a note, chord, or beam, which
+        // need another element beside them.
+        bool m_invalid;
+        bool m_pairs;
+    };
+
+    // The model sums durations only to scale a tuplet, so they are only
+    // needed inside one.  Double dotted sixtyfourths have no duration, and
+    // the model throws if it needs one.
+    duration length(const value &v)
+    {
+        static constexpr value unlisted = dot(dot(value::sixtyfourth()));
+        if (m_tuplets == 0) {
+            return duration::zero();
+        }
+        if (v == unlisted) {
+            m_valid = false;
+            return duration::zero();
+        }
+        return v;
+    }
+
+    // Add an element, summing durations in the same order as the model.
+    void add(kind k, const value &v, const duration &d)
+    {
+        frame &f = m_frames[m_depth];
+        if (m_tuplets != 0) {
+            f.m_duration = f.m_duration + d;
+        }
+        ++f.m_size;
+        switch (k) {
+        case kind::rest:
+        case kind::change:
+            f.m_invalid = true;
+            break;
+        case kind::note:
+        case kind::chord:
+            f.m_invalid = f.m_invalid or v > value::quarter();
+            f.m_pairs = true;
+            break;
+        case kind::beam:
+            f.m_pairs = true;
+            break;
+        case kind::tuplet:
+            f.m_invalid = f.m_invalid or v > value::quarter();
+            break;
+        }
+    }
+
+    bool m_valid = true;
+
+    // Frame 0 holds the top level column.
+    std::array<frame, max_depth + 1> m_frames;
+    std::size_t m_depth = 0;
+    std::size_t m_tuplets = 0;
+
+    // The pitches of the current chord; chords do not nest.
+    std::bitset<256 * 8> m_pitches;
+    std::size_t m_size = 0;
+};
+
+} // namespace stan::lilypond
@@ -0,0 +1,25 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+
+#include "predictive.hpp"
+#include "validating_sink.hpp"
+
+namespace stan::lilypond {
+
+bool validator::operator()(std::string_view lily) const
+{
+    validating_sink sink;
+    predictive_parser<validating_sink> p(lily, sink);
+    try {
+        if (!p.column()) {
+            return false;
+        }
+    } catch (const exception &) {
+        // Nested too deep, which is the one error the parser throws.
+        return false;
+    }
+    p.skip();
+    return p.done() and sink.valid();
+}
+
+} // namespace stan::lilypond
@@ -0,0 +1,257 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include <stan/exception.hpp>
+
+#include "scanner.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+
+namespace stan::lilypond {
+
+namespace {
+
+bool is_letter(char c)
+{
+    return (c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z');
+}
+
+// The words that follow a backslash in the language itself, which are never
+// references.
+bool reserved(std::string_view name)
+{
+    static constexpr std::string_view words[] = { "tuplet", "time",  "clef",  "key",
+                                                   "major",  "minor", "repeat" };
+    return std::find(std::begin(words), std::end(words), name) != std::end(words);
+}
+
+std::string_view word(std::string_view lily, std::size_t first)
+{
+    std::size_t last = first;
+    while (last < lily.size() and is_letter(lily[last])) {
+        ++last;
+    }
+    return lily.substr(first, last - first);
+}
+
+void skip(std::string_view lily, std::size_t &i)
+{
+    while (i < lily.size() and is_space(lily[i])) {
+        ++i;
+    }
+}
+
+// Add music to the parts of another, played count times.
+void add(shared_music &music, std::shared_ptr<const shared_music> other, std::uint32_t count)
+{
+    music.m_size += count * other->m_size;
+    music.m_duration = music.m_duration + static_cast<int>(count) * other->m_duration;
+    music.m_parts.push_back({ std::move(other), 0, 0, count });
+}
+
+} // namespace
+
+shared_music::iterator shared_music::begin() const
+{
+    iterator i;
+    i.m_stack.push_back({ this, 0, 0 });
+    i.settle();
+    return i;
+}
+
+shared_music::iterator shared_music::end() const
+{
+    iterator i;
+    i.m_index = m_size;
+    return i;
+}
+
+shared_music::iterator &shared_music::iterator::operator++()
+{
+    ++m_stack.back().m_position;
+    ++m_index;
+    settle();
+    return *this;
+}
+
+void shared_music::iterator::settle()
+{
+    while (!m_stack.empty()) {
+        frame &f = m_stack.back();
+        if (f.m_part == f.m_music->m_parts.size()) {
+            m_stack.pop_back();
+            if (!m_stack.empty()) {
+                ++m_stack.back().m_position;
+            }
+            continue;
+        }
+
+        const part &p = f.m_music->m_parts[f.m_part];
+        if (!p.m_music) {
+            if (f.m_position < p.m_last - p.m_first) {
+                m_column = &f.m_music->m_columns[p.m_first + f.m_position];
+                return;
+            }
+        } else if (f.m_position < p.m_count and p.m_music->m_size != 0) {
+            m_stack.push_back({ p.m_music.get(), 0, 0 });
+            continue;
+        }
+        ++f.m_part;
+        f.m_position = 0;
+    }
+    m_column = nullptr;
+}
+
+std::vector<column> shared_music::expand() const
+{
+    std::vector<column> music;
+    music.reserve(m_size);
+    for_each([&music](const column &c) { music.push_back(c); });
+    return music;
+}
+
+std::shared_ptr<const shared_music> variable_reader::operator()(std::string_view lily)
+{
+    m_variables.clear();
+    m_text = lily;
+    m_brackets = bracket_pairs(lily);
+
+    std::size_t i = 0;
+    for (;;) {
+        skip(lily, i);
+        if (i == lily.size()) {
+            throw std::runtime_error("parse error");
+        }
+
+        std::string_view name;
+        if (lily[i] != '{') {
+            name = word(lily, i);
+            i += name.size();
+            skip(lily, i);
+            if (name.empty() or reserved(name) or i == lily.size() or lily[i] != '=') {
+                throw std::runtime_error("parse error");
+            }
+            ++i;
+            skip(lily, i);
+            if (i == lily.size() or lily[i] != '{') {
+                throw std::runtime_error("parse error");
+            }
+        }
+
+        std::size_t close = closing(lily, i);
+        std::shared_ptr<const shared_music> music = body(lily.substr(i + 1, close - i - 1), 0);
+        i = close + 1;
+
+        if (name.empty()) {
+            skip(lily, i);
+            if (i != lily.size()) {
+                throw std::runtime_error("incomplete parse");
+            }
+            return music;
+        }
+        m_variables.insert_or_assign(std::string(name), std::move(music));
+    }
+}
+
+// Split the body of a sequence at each top level reference, parsing the
+// columns in between.
+std::shared_ptr<const shared_music> variable_reader::body(std::string_view lily,
+                                                          std::size_t repeats)
+{
+    auto music = std::make_shared<shared_music>();
+    auto own = [this, &music](std::string_view text) {
+        std::size_t first = music->m_columns.size();
+        m_reader.append(text, music->m_columns);
+        std::size_t last = music->m_columns.size();
+        if (first != last) {
+            music->m_parts.push_back({ nullptr, first, last });
+            music->m_size += last - first;
+            for (std::size_t i = first; i < last; ++i) {
+                music->m_duration = music->m_duration + music->m_columns[i];
+            }
+        }
+    };
+
+    std::size_t start = 0;
+    int depth = 0;
+    for (std::size_t i = 0; i < lily.size(); ++i) {
+        char c = lily[i];
+        if (c == '[' or c == '{' or c == '<') {
+            ++depth;
+        } else if (c == ']' or c == '}' or c == '>') {
+            --depth;
+        } else if (c == '\\' and depth == 0 and (i == 0 or is_space(lily[i - 1]))) {
+            std::string_view name = word(lily, i + 1);
+            if (name == "repeat") {
+                own(lily.substr(start, i - start));
+                start = repeat(lily, i + 1 + name.size(), *music, repeats);
+                i = start - 1;
+                continue;
+            }
+            if (name.empty() or reserved(name)) {
+                continue;
+            }
+
+            auto variable = m_variables.find(name);
+            if (variable == m_variables.end()) {
+                throw exception("\\{} is not defined", name);
+            }
+
+            own(lily.substr(start, i - start));
+            add(*music, variable->second, 1);
+            start = i + 1 + name.size();
+            i = start - 1;
+        }
+    }
+    own(lily.substr(start));
+
+    return music;
+}
+
+// The type of the repeat, its count, and its body, which may hold references
+// and repeats of its own.
+std::size_t variable_reader::repeat(std::string_view lily, std::size_t i, shared_music &music,
+                                    std::size_t repeats)
+{
+    if (repeats == max_depth) {
+        throw exception("repeats nest deeper than {} levels", max_depth);
+    }
+
+    skip(lily, i);
+    std::string_view type = word(lily, i);
+    if (type != "volta" and type != "unfold" and type != "percent") {
+        throw std::runtime_error("parse error");
+    }
+    i += type.size();
+    skip(lily, i);
+
+    std::uint32_t count = 0;
+    auto [last, error] = std::from_chars(lily.data() + i, lily.data() + lily.size(), count);
+    if (error != std::errc() or count == 0) {
+        throw std::runtime_error("parse error");
+    }
+    i = last - lily.data();
+    skip(lily, i);
+    if (i == lily.size() or lily[i] != '{') {
+        throw std::runtime_error("parse error");
+    }
+
+    std::size_t close = closing(lily, i);
+    add(music, body(lily.substr(i + 1, close - i - 1), repeats + 1), count);
+    return close + 1;
+}
+
+std::size_t variable_reader::closing(std::string_view lily, std::size_t open) const
+{
+    std::size_t offset = lily.data() - m_text.data();
+    auto pair = std::lower_bound(m_brackets.begin(), m_brackets.end(),
+                                 std::pair(offset + open, std::size_t{ 0 }));
+    if (pair == m_brackets.end() or pair->first != offset + open or
+        pair->second >= offset + lily.size() or m_text[pair->second] != '}') {
+        throw std::runtime_error("parse error");
+    }
+    return pair->second - offset;
+}
+
+} // namespace stan::lilypond
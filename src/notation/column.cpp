@@ -4,6 +4,7 @@
 #include <stan/driver/debug.hpp>
 #include <stan/driver/lilypond.hpp>
 
+#include <limits>
 #include <numeric>
 
 namespace stan {
@@ -32,18 +33,48 @@ duration operator+(stan::duration const &d, stan::column const &c)
     return d + std::visit(get_duration(), c);
 }
 
-value tuplet::scale(int num, int den, const duration &inner)
+namespace {
+
+// The ratio can be any positive int, so the outer duration is reduced in 64
+// bits rather than constructed, where it could overflow.
+std::pair<std::uint64_t, std::uint64_t> outer(int num, int den, const duration &inner)
+{
+    std::uint64_t n = std::uint64_t{ inner.num() } * static_cast<std::uint64_t>(den);
+    std::uint64_t d = std::uint64_t{ inner.den() } * static_cast<std::uint64_t>(num);
+    std::uint64_t gcd = std::gcd(n, d);
+    return { n / gcd, d / gcd };
+}
+
+} // namespace
+
+std::optional<value> tuplet::fit(int num, int den, const duration &inner)
 {
-    stan::duration outer(inner.num() * den, inner.den() * num);
+    if (num <= 0 or den <= 0) {
+        return std::nullopt;
+    }
 
+    auto [n, d] = outer(num, den, inner);
     for (const stan::value &val : stan::value::all) {
-        if (outer == static_cast<duration>(val)) {
+        duration v = val;
+        if (n == v.num() and d == v.den()) {
             return val;
         }
     }
+    return std::nullopt;
+}
+
+value tuplet::scale(int num, int den, const duration &inner)
+{
+    if (num <= 0 or den <= 0) {
+        throw invalid_tuplet("ratio {}/{} must be positive", num, den);
+    }
+    if (std::optional<value> v = fit(num, den, inner)) {
+        return *v;
+    }
+
+    auto [n, d] = outer(num, den, inner);
     throw invalid_tuplet("duration ({}/{}:{{{}}} = {}/{}) must equal a valid value",
-                         num, den, stan::driver::debug::write(inner),
-                         outer.num(), outer.den());
+                         num, den, stan::driver::debug::write(inner), n, d);
 }
 
 value tuplet::scale(int num, int den, const value &inner)
@@ -51,6 +82,34 @@ value tuplet::scale(int num, int den, const value &inner)
     return tuplet::scale(num, den, static_cast<duration>(inner));
 }
 
+tuplet::tuplet(int num, int den, std::pmr::vector<column> &&n) :
+    m_value(scale(num, den, n)), m_elements(std::move(n))
+{
+    validate();
+    int gcd = std::gcd(num, den);
+    m_num = num / gcd;
+    m_den = den / gcd;
+}
+
+void tuplet::compute_ratio()
+{
+    duration inner = std::accumulate(
+        m_elements.begin(),
+        m_elements.end(),
+        duration::zero(),
+        [](duration res, const auto &p) { return res + p; });
+    std::uint64_t n = std::uint64_t{ inner.num() } * m_value.den();
+    std::uint64_t d = std::uint64_t{ inner.den() } * m_value.num();
+    std::uint64_t gcd = std::gcd(n, d);
+    n /= gcd;
+    d /= gcd;
+    if (n == 0 or n > std::numeric_limits<int>::max() or d > std::numeric_limits<int>::max()) {
+        throw invalid_tuplet("ratio {}/{} is out of range", n, d);
+    }
+    m_num = static_cast<int>(n);
+    m_den = static_cast<int>(d);
+}
+
 void tuplet::validate() const
 {
     if (m_elements.size() < 2) {
@@ -125,6 +184,21 @@ void beam::validate() const
             }
             return std::string();
         }
+
+        std::string operator()(meter const &) const
+        {
+            return "cannot contain meter changes";
+        }
+
+        std::string operator()(clef const &) const
+        {
+            return "cannot contain clef changes";
+        }
+
+        std::string operator()(key const &) const
+        {
+            return "cannot contain key changes";
+        }
     };
 
     std::for_each(
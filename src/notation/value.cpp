@@ -8,29 +8,6 @@ namespace stan {
 
 static driver::debug::writer debug;
 
-value dot(const value &v)
-{
-    // The operation is either going from 0->1 dot, or 1->2 dots.  There
-    // are no other valid situations.
-    if (v.num() != 1 and v.num() != 3) {
-        throw invalid_value("values can have exactly 0, 1, or 2 dots");
-    }
-    return {
-        static_cast<value::integer>(2 * v.num() + 1),
-        static_cast<value::integer>(2 * v.den())
-    };
-}
-
-value dimin(const value &v)
-{
-    return { v.num(), static_cast<value::integer>(v.den() * 2) };
-}
-
-value augment(const value &v)
-{
-    return { v.num(), static_cast<value::integer>(v.den() / 2) };
-}
-
 const std::vector<value> value::all{
     whole(),
     half(),
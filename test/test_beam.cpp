@@ -60,5 +60,14 @@ mettle::suite<> suite("beam", [](auto &_) {
         expect([] { beam{ column(beam{ c8, c8 }) }; },
                thrown<stan::invalid_beam>(
                    "invalid beam: nested beams must contain at least two elements"));
+
+        expect([] { beam{ c8, meter{ { 3 }, quarter } }; },
+               thrown<stan::invalid_beam>("invalid beam: cannot contain meter changes"));
+
+        expect([] { beam{ c8, clef{ clef::type::bass } }; },
+               thrown<stan::invalid_beam>("invalid beam: cannot contain clef changes"));
+
+        expect([] { beam{ c8, key{ pc::g, mode::major } }; },
+               thrown<stan::invalid_beam>("invalid beam: cannot contain key changes"));
     });
 });
@@ -75,4 +75,24 @@ mettle::suite<> suite("key", [](auto &_) {
             key k2 = k1;
             expect(k1, mettle::equal_to(k2));
         }); 
+
+    _.test("mode id", []() {
+            expect(key(pc::g, mode::major).m_mode_id, equal_to(mode::major_id));
+            expect(key(pc::g, mode::minor).m_mode_id, equal_to(mode::minor_id));
+            expect(key(pc::g, mode::major).major(), equal_to(true));
+            expect(key(pc::g, mode::minor).minor(), equal_to(true));
+
+            // Other modes share an id, and compare by their degrees.
+            const std::vector<std::uint8_t> dorian { 0, 2, 3, 5, 7, 9, 10 };
+            const std::vector<std::uint8_t> phrygian { 0, 1, 3, 5, 7, 8, 10 };
+            key d1 { pc::d, dorian };
+            key d2 { pc::d, dorian };
+            key e { pc::d, phrygian };
+            expect(d1.m_mode_id, equal_to(mode::other_id));
+            expect(d1.major() or d1.minor(), equal_to(false));
+            expect(d1 == d2, equal_to(true));
+            expect(d1 == e, equal_to(false));
+            expect(d1 == key(pc::d, mode::minor), equal_to(false));
+            expect(d1.mode_degrees(), equal_to(key::degrees{ 0, 2, 3, 5, 7, 9, 10 }));
+        });
 });
@@ -0,0 +1,160 @@
+#include <stan/notation.hpp>
+#include <stan/driver/lilypond.hpp>
+#include "to_printable.hpp"
+
+#include <mettle.hpp>
+#include "property.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using mettle::equal_to;
+using mettle::expect;
+using mettle::less_equal;
+
+// Count every allocation made while a parse is running, by replacing the
+// global operator new for this test program only.  The notation containers
+// allocate through std::pmr, whose default resource uses the aligned forms.
+
+static std::atomic<bool> counting{ false };
+static std::atomic<std::size_t> allocations{ 0 };
+
+void *operator new(std::size_t size)
+{
+    if (counting) {
+        ++allocations;
+    }
+    if (void *p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (counting) {
+        ++allocations;
+    }
+    auto a = static_cast<std::size_t>(alignment);
+    if (void *p = std::aligned_alloc(a, (size + a - 1) / a * a + (size == 0 ? a : 0))) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+// Every beam, tuplet, chord, and meter owns exactly one vector.  A key holds
+// its mode in place.
+struct heap_nodes
+{
+    template <typename T>
+    std::size_t operator()(const T &) const { return 0; }
+
+    std::size_t operator()(const stan::chord &) const { return 1; }
+    std::size_t operator()(const stan::meter &) const { return 1; }
+    std::size_t operator()(const stan::beam &v) const { return 1 + elements(v.m_elements); }
+    std::size_t operator()(const stan::tuplet &v) const { return 1 + elements(v.m_elements); }
+
+    std::size_t elements(const std::pmr::vector<stan::column> &e) const
+    {
+        std::size_t n = 0;
+        for (const auto &c : e) {
+            n += std::visit(*this, c);
+        }
+        return n;
+    }
+};
+
+mettle::suite<
+    stan::rest,
+    stan::note,
+    stan::chord,
+    stan::beam,
+    stan::tuplet,
+    stan::meter,
+    stan::clef,
+    stan::key
+    >
+    suite(
+        "lilypond reader allocation", mettle::type_only, [](auto &_) {
+            using Event = mettle::fixture_type_t<decltype(_)>;
+
+            property(_, "one allocation per heap node", [](Event n) {
+                static stan::lilypond::writer write;
+                static stan::lilypond::reader read;
+
+                std::string lily = write(n);
+
+                // The first parse warms up the reader's scratch space.
+                read(lily);
+
+                allocations = 0;
+                counting = true;
+                stan::column c = read(lily);
+                counting = false;
+
+                expect(allocations.load(), less_equal(std::visit(heap_nodes(), c)));
+            });
+
+            property(_, "no allocations from a warmed up arena", [](Event n) {
+                static stan::lilypond::writer write;
+                static stan::lilypond::reader read(stan::lilypond::arena);
+
+                std::string lily = write(n);
+
+                // The first parse grows the arena to fit.
+                read(lily);
+                read.release();
+
+                allocations = 0;
+                counting = true;
+                stan::column c = read(lily);
+                counting = false;
+
+                expect(allocations.load(), equal_to(0u));
+                expect(c, equal_to<stan::column>(stan::column{ n }));
+            });
+
+            property(_, "no allocations reading and writing events", [](Event n) {
+                static stan::lilypond::writer write;
+                static stan::lilypond::event_reader read;
+
+                std::string lily = write(n);
+                std::string out;
+                out.reserve(2 * lily.size());
+                stan::lilypond::event_writer writer(out);
+                stan::lilypond::event_filter filter(writer);
+
+                // The first pass warms up the reader's chord buffer.
+                read(lily, filter);
+                out.clear();
+
+                allocations = 0;
+                counting = true;
+                read(lily, filter);
+                counting = false;
+
+                expect(allocations.load(), equal_to(0u));
+                expect(out, equal_to(lily));
+            });
+        });
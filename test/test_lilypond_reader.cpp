@@ -1,11 +1,21 @@
 #include <stan/notation.hpp>
 #include <stan/driver/lilypond.hpp>
+#include <stan/driver/lilypond/literals.hpp>
 #include <stan/driver/debug.hpp>
+#include <stan/thread_pool.hpp>
 #include "to_printable.hpp"
 
 #include <mettle.hpp>
 #include "property.hpp"
 
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+#include <sstream>
+
 using mettle::equal_to;
 using mettle::expect;
 using mettle::thrown;
@@ -23,6 +33,7 @@ mettle::suite<
     suite(
         "lilypond reader", mettle::type_only, [](auto &_) {
             static stan::lilypond::reader read;
+            static stan::lilypond::predictive_reader predict;
             static stan::lilypond::writer write;
             static stan::driver::debug::writer debug;
 
@@ -34,9 +45,1202 @@ mettle::suite<
                 expect(read(lily), equal_to<stan::column>(stan::column{ n }));
             });
 
+            property(_, "write_to", [](Event n) {
+                fmt::memory_buffer buffer;
+                write.write_to(buffer, n);
+                write.write_to(buffer, n);
+                expect(fmt::to_string(buffer), equal_to(write(n) + write(n)));
+
+                std::string lily;
+                write.write_to(std::back_inserter(lily), n);
+                expect(lily, equal_to(write(n)));
+            });
+
             property(_, "parse error", [](Event n) {
                 std::string lily = write(n) + " crash";
                 expect([lily] { read(lily); },
                        thrown<std::runtime_error>("incomplete parse"));
             });
+
+            property(_, "result writeread", [](Event n) {
+                std::string lily = write(n);
+                auto result = read.parse(lily);
+                expect(result.has_value(), equal_to(true));
+                expect(*result, equal_to<stan::column>(stan::column{ n }));
+            });
+
+            property(_, "result parse error", [](Event n) {
+                std::string lily = write(n) + " crash";
+                auto result = read.parse(lily);
+                expect(result.has_value(), equal_to(false));
+                expect(result.error().m_offset, equal_to(lily.size() - 5));
+                expect(result.error().m_expected, equal_to("end of input"));
+                expect(result.error().m_message, equal_to("incomplete parse"));
+            });
+
+            property(_, "predictive writeread", [](Event n) {
+                std::string lily = write(n);
+                expect(predict(lily), equal_to<stan::column>(stan::column{ n }));
+            });
+
+            property(_, "predictive parse error", [](Event n) {
+                std::string lily = write(n) + " crash";
+                expect([lily] { predict(lily); },
+                       thrown<std::runtime_error>("incomplete parse"));
+            });
+
+            // Both backends must agree on every prefix, including the ones
+            // that do not parse.
+            property(_, "predictive prefix", [](Event n) {
+                std::string lily = write(n);
+                for (std::size_t i = 0; i <= lily.size(); ++i) {
+                    std::string prefix = lily.substr(0, i);
+                    std::string expected;
+                    std::string actual;
+                    try {
+                        expected = write(read(prefix));
+                    } catch (std::exception &e) {
+                        expected = e.what();
+                    }
+                    try {
+                        actual = write(predict(prefix));
+                    } catch (std::exception &e) {
+                        actual = e.what();
+                    }
+                    expect(actual, equal_to(expected));
+                }
+            });
+
+            property(_, "validator writeread", [](Event n) {
+                stan::lilypond::validator valid;
+                expect(valid(write(n)), equal_to(true));
+                expect(valid(write(n) + " crash"), equal_to(false));
+            });
+
+            // The validator accepts exactly what the reader reads.
+            property(_, "validator prefix", [](Event n) {
+                stan::lilypond::validator valid;
+                std::string lily = write(n);
+                for (std::size_t i = 0; i <= lily.size(); ++i) {
+                    std::string prefix = lily.substr(0, i);
+                    expect(valid(prefix), equal_to(read.parse(prefix).has_value()));
+                }
+            });
+        });
+
+mettle::suite<> sequence_suite("lilypond sequence reader", [](auto &_) {
+    static stan::lilypond::writer write;
+
+    property(_, "writeread", [](std::vector<stan::column> music) {
+        std::stringstream lily;
+        lily << "{ ";
+        for (const auto &c : music) {
+            lily << write(c) << " ";
+        }
+        lily << "}";
+
+        std::vector<stan::column> result;
+        for (auto &c : stan::lilypond::sequence_reader(lily)) {
+            result.push_back(std::move(c));
+        }
+        expect(result, equal_to(music));
+    });
+
+    property(_, "string_view", [](std::vector<stan::column> music) {
+        std::string lily = "{";
+        for (const auto &c : music) {
+            lily += " " + write(c);
+        }
+        lily += " }";
+
+        std::vector<stan::column> result;
+        for (auto &c : stan::lilypond::sequence_reader(std::string_view(lily))) {
+            result.push_back(std::move(c));
+        }
+        expect(result, equal_to(music));
+    });
+
+    _.test("mapped file", []() {
+        const std::string path = "ut.lilypond_reader.ly";
+        std::ofstream(path) << "{ c4 [d8 e8] \\key d \\minor }\n";
+
+        std::vector<stan::column> result;
+        for (auto &c : stan::lilypond::sequence_reader(stan::lilypond::mapped_file(path))) {
+            result.push_back(std::move(c));
+        }
+        std::remove(path.c_str());
+
+        expect(result.size(), equal_to(3u));
+        expect(write(result[1]), equal_to("[d8 e8]"));
+    });
+
+    _.test("missing file", []() {
+        expect([] { stan::lilypond::mapped_file("ut.lilypond_reader.missing.ly"); },
+               thrown<stan::exception>());
+    });
+
+    _.test("empty", []() {
+        std::istringstream lily("{ }");
+        stan::lilypond::sequence_reader read(lily);
+        expect(read.next().has_value(), equal_to(false));
+    });
+
+    _.test("parse error", []() {
+        std::istringstream lily("{ c4 d4 crash }");
+        stan::lilypond::sequence_reader read(lily);
+        expect(read.next().has_value(), equal_to(true));
+        expect(read.next().has_value(), equal_to(true));
+        expect([&read] { read.next(); },
+               thrown<std::runtime_error>("parse error"));
+    });
+
+    _.test("incomplete parse", []() {
+        std::istringstream lily("{ c4 } crash");
+        stan::lilypond::sequence_reader read(lily);
+        expect(read.next().has_value(), equal_to(true));
+        expect([&read] { read.next(); },
+               thrown<std::runtime_error>("incomplete parse"));
+    });
+});
+
+mettle::suite<> error_suite("lilypond reader errors", [](auto &_) {
+    static stan::lilypond::reader read;
+    static stan::lilypond::writer write;
+
+    auto error = [](std::string_view lily) { return read.parse(lily).error(); };
+
+    _.test("offset and expected rule", [error]() {
+        expect(error("c").m_offset, equal_to(1u));
+        expect(error("c").m_expected, equal_to("value"));
+        expect(error("x4").m_offset, equal_to(0u));
+        expect(error("x4").m_expected, equal_to("column"));
+        expect(error("[c4 d4").m_offset, equal_to(6u));
+        expect(error("[c4 d4").m_expected, equal_to("']'"));
+        expect(error(R"(\tuplet 3/2 c8)").m_offset, equal_to(12u));
+        expect(error(R"(\tuplet 3/2 c8)").m_expected, equal_to("'{'"));
+        expect(error(R"(\key c \foo)").m_expected, equal_to("mode"));
+        expect(error("c4 d4").m_message, equal_to("parse error"));
+    });
+
+    _.test("notation error", [error]() {
+        auto e = error("<d e e>4");
+        expect(e.m_offset, equal_to(0u));
+        expect(e.m_expected, equal_to("chord"));
+        expect(e.m_message, equal_to("invalid chord: unique pitches required"));
+    });
+
+    _.test("value", []() {
+        expect([] { read.parse("c4 crash").value(); },
+               thrown<std::runtime_error>("incomplete parse"));
+    });
+
+    _.test("recover", []() {
+        std::vector<stan::column> music;
+        auto errors = read.recover("c4 x4 [d8 e8] <c c>4 f4 [g8 y8] a2", music);
+
+        expect(music.size(), equal_to(4u));
+        expect(write(music[1]), equal_to("[d8 e8]"));
+        expect(write(music[3]), equal_to("a2"));
+
+        expect(errors.size(), equal_to(3u));
+        expect(errors[0].m_offset, equal_to(3u));
+        expect(errors[1].m_offset, equal_to(14u));
+        expect(errors[1].m_expected, equal_to("chord"));
+        expect(errors[2].m_offset, equal_to(28u));
+    });
+});
+
+mettle::suite<> incremental_suite("lilypond incremental reader", [](auto &_) {
+    static stan::lilypond::writer write;
+
+    // Random edits, each checked against a full re-parse in recovery mode.
+    // Meter, clef and key columns are left out, and so are tuplets other than
+    // the 3/2 ones the edits make, so that no edit can build an object that
+    // the notation model asserts on rather than throws.
+    property(_, "same as full re-parse", [](std::vector<stan::column> music) {
+        static const std::vector<std::string> fragments{
+            " ", "c4", "r8", "[", "]", "<", ">", "{", "}", ".", "'", "8", "x",
+            R"(\tuplet 3/2 {)", R"(\clef)", R"(\key)", "<c e>4", "[d8 e8]"
+        };
+
+        std::string lily;
+        for (const auto &c : music) {
+            if (std::holds_alternative<stan::note>(c) or std::holds_alternative<stan::rest>(c) or
+                std::holds_alternative<stan::chord>(c) or std::holds_alternative<stan::beam>(c)) {
+                lily += write(c) + " ";
+            }
+        }
+
+        stan::lilypond::incremental_reader incremental(lily);
+        int edits = *rc::gen::inRange(1, 20);
+        for (int i = 0; i < edits; ++i) {
+            // Some edits at the very end, where nothing follows the last item.
+            auto offset = *rc::gen::inRange(0, 4) == 0
+                ? lily.size() - std::min<std::size_t>(lily.size(), *rc::gen::inRange(0, 8))
+                : *rc::gen::inRange<std::size_t>(0, lily.size() + 1);
+            auto length = *rc::gen::inRange<std::size_t>(
+                0, std::min<std::size_t>(lily.size() - offset, 8) + 1);
+            auto text = *rc::gen::elementOf(fragments);
+
+            lily.replace(offset, length, text);
+            incremental.edit(offset, length, text);
+
+            std::vector<stan::column> expected;
+            auto errors = stan::lilypond::reader().recover(lily, expected);
+            expect(incremental.text(), equal_to(lily));
+            expect(incremental.music(), equal_to(expected));
+
+            auto actual = incremental.errors();
+            expect(actual.size(), equal_to(errors.size()));
+            for (std::size_t e = 0; e < std::min(actual.size(), errors.size()); ++e) {
+                expect(actual[e].m_offset, equal_to(errors[e].m_offset));
+                expect(actual[e].m_message, equal_to(errors[e].m_message));
+            }
+
+            auto extents = incremental.extents();
+            auto fresh = stan::lilypond::incremental_reader(lily).extents();
+            expect(extents.size(), equal_to(fresh.size()));
+            for (std::size_t e = 0; e < std::min(extents.size(), fresh.size()); ++e) {
+                expect(extents[e].m_first, equal_to(fresh[e].m_first));
+                expect(extents[e].m_last, equal_to(fresh[e].m_last));
+            }
+        }
+    });
+
+    _.test("extents", []() {
+        stan::lilypond::incremental_reader incremental("c4 [d8 e8]  f4");
+        incremental.edit(4, 1, "g");
+        expect(write(incremental.music()[1]), equal_to("[g8 e8]"));
+        expect(incremental.extents().size(), equal_to(3u));
+        expect(incremental.extents()[1].m_first, equal_to(3u));
+        expect(incremental.extents()[1].m_last, equal_to(10u));
+        expect(incremental.extents()[2].m_first, equal_to(12u));
+    });
+
+    _.test("errors", []() {
+        stan::lilypond::incremental_reader incremental("c4 d4 e4");
+        incremental.edit(3, 2, "x4");
+        expect(incremental.music().size(), equal_to(2u));
+        expect(incremental.errors().size(), equal_to(1u));
+        expect(incremental.errors()[0].m_offset, equal_to(3u));
+
+        incremental.edit(0, 0, "  ");
+        expect(incremental.errors()[0].m_offset, equal_to(5u));
+
+        incremental.edit(5, 1, "d");
+        expect(incremental.music().size(), equal_to(3u));
+        expect(incremental.errors().size(), equal_to(0u));
+    });
+
+    _.test("end of buffer", []() {
+        stan::lilypond::incremental_reader incremental("[c4f16] ");
+        incremental.edit(4, 3, "");
+        expect(incremental.errors().size(), equal_to(2u));
+        expect(incremental.errors()[0].m_offset, equal_to(0u));
+        expect(incremental.errors()[1].m_offset, equal_to(5u));
+        expect(incremental.extents().size(), equal_to(3u));
+        expect(incremental.extents()[2].m_first, equal_to(3u));
+        expect(incremental.extents()[2].m_last, equal_to(5u));
+
+        stan::lilypond::incremental_reader clef("\\cleftreble ");
+        clef.edit(1, 6, "");
+        expect(clef.extents().size(), equal_to(1u));
+        expect(clef.extents()[0].m_first, equal_to(0u));
+        expect(clef.extents()[0].m_last, equal_to(6u));
+    });
+
+    _.test("unbalanced", []() {
+        stan::lilypond::incremental_reader incremental("c4 d4 e4 f4");
+        incremental.edit(3, 0, "[");
+        expect(incremental.music().size(), equal_to(4u));
+        expect(incremental.errors().size(), equal_to(1u));
+        expect(incremental.errors()[0].m_offset, equal_to(3u));
+
+        incremental.edit(9, 0, "]");
+        expect(incremental.music().size(), equal_to(3u));
+        expect(write(incremental.music()[1]), equal_to("[d4 e4]"));
+        expect(incremental.errors().size(), equal_to(0u));
+
+        incremental.edit(3, 1, "");
+        expect(incremental.music().size(), equal_to(4u));
+        expect(incremental.errors().size(), equal_to(1u));
+        expect(incremental.errors()[0].m_offset, equal_to(8u));
+    });
+
+    // A bracket that does not balance is an error of its own, so typing one
+    // costs no more than any other keystroke, rather than a parse of the rest
+    // of the document.  Very generous, so that it holds in a debug build.
+    _.test("unbalanced latency", []() {
+        std::string lily;
+        for (int i = 0; i < 20000; ++i) {
+            lily += "c4 [d8 e8] ";
+        }
+        stan::lilypond::incremental_reader incremental(lily);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < 10; ++i) {
+            incremental.edit(lily.size() / 2, 0, "[");
+            incremental.edit(lily.size() / 2, 1, "");
+        }
+        std::chrono::duration<double> edits = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        std::vector<stan::column> music;
+        stan::lilypond::reader().recover(lily, music);
+        std::chrono::duration<double> full = std::chrono::steady_clock::now() - start;
+
+        expect(edits.count() < full.count(), equal_to(true));
+        expect(incremental.music(), equal_to(music));
+    });
+
+    _.test("out of range", []() {
+        stan::lilypond::incremental_reader incremental("c4");
+        expect([&incremental] { incremental.edit(1, 2, ""); },
+               thrown<std::out_of_range>());
+    });
+});
+
+mettle::suite<> parallel_suite("lilypond parallel reader", [](auto &_) {
+    static stan::lilypond::writer write;
+    static stan::thread_pool pool(4);
+
+    auto drain = [](std::string_view lily) {
+        std::vector<stan::column> result;
+        for (auto &c : stan::lilypond::sequence_reader(lily)) {
+            result.push_back(std::move(c));
+        }
+        return result;
+    };
+
+    // With a minimum chunk of one byte, every boundary is a candidate split.
+    property(_, "same as sequential", [drain](std::vector<stan::column> music) {
+        std::string lily = "{";
+        for (const auto &c : music) {
+            lily += " " + write(c);
+        }
+        lily += " }";
+
+        stan::lilypond::parallel_reader read(pool, 1);
+        expect(read(lily), equal_to(drain(lily)));
+    });
+
+    _.test("commands", []() {
+        stan::lilypond::parallel_reader read(pool, 1);
+        auto music = read(R"({ \key d \minor c4 \clef bass d4 \time 3/4 [e8 f8] })");
+        expect(music.size(), equal_to(6u));
+        expect(write(music[0]), equal_to(R"(\key d \minor)"));
+        expect(write(music[2]), equal_to(R"(\clef bass)"));
+    });
+
+    _.test("parse error", []() {
+        stan::lilypond::parallel_reader read(pool, 1);
+        expect([&read] { read("{ c4 d4 crash }"); },
+               thrown<std::runtime_error>("parse error"));
+        expect([&read] { read("c4"); },
+               thrown<std::runtime_error>("parse error"));
+    });
+
+    _.test("incomplete parse", []() {
+        stan::lilypond::parallel_reader read(pool, 1);
+        expect([&read] { read("{ c4 } crash"); },
+               thrown<std::runtime_error>("incomplete parse"));
+        expect([&read] { read("{ c4 } }"); },
+               thrown<std::runtime_error>("incomplete parse"));
+    });
+});
+
+mettle::suite<> batch_suite("lilypond batch reader", [](auto &_) {
+    static stan::lilypond::writer write;
+    static stan::thread_pool pool(4);
+
+    property(_, "same as one at a time", [](std::vector<stan::column> music) {
+        std::vector<std::string> snippets;
+        for (const auto &c : music) {
+            snippets.push_back(write(c));
+        }
+
+        stan::lilypond::batch_reader read(pool);
+        auto results = read(snippets);
+        expect(results.size(), equal_to(music.size()));
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            expect(results[i].value(), equal_to(music[i]));
+        }
+    });
+
+    _.test("errors in order", []() {
+        stan::lilypond::batch_reader read(pool);
+        for (int batch = 0; batch < 3; ++batch) {
+            {
+                std::vector<std::string> snippets;
+                for (int i = 0; i < 1000; ++i) {
+                    snippets.push_back(i % 3 == 0 ? "[c8 crash]" : "r" + std::to_string(1 << (i % 4)));
+                }
+
+                auto results = read(snippets);
+                expect(results.size(), equal_to(snippets.size()));
+                for (std::size_t i = 0; i < results.size(); ++i) {
+                    if (i % 3 == 0) {
+                        expect(results[i].has_value(), equal_to(false));
+                        expect(results[i].error().m_offset, equal_to(5u));
+                    } else {
+                        expect(write(results[i].value()), equal_to(snippets[i]));
+                    }
+                }
+            }
+            read.release();
+        }
+    });
+
+    _.test("empty", []() {
+        stan::lilypond::batch_reader read(pool);
+        expect(read(std::vector<std::string_view>{}).size(), equal_to(0u));
+    });
+});
+
+
+// Check the subtree at nodes()[i] of a skeleton against the column it should
+// build.
+static void check_skeleton(const stan::lilypond::skeleton &s, std::size_t i,
+                           const stan::column &c)
+{
+    static stan::lilypond::reader read;
+
+    const auto &n = s.nodes()[i];
+    expect(static_cast<std::size_t>(n.m_kind), equal_to(c.index()));
+    expect(s.build(n, read), equal_to(c));
+
+    std::vector<stan::column> elements;
+    if (auto *b = std::get_if<stan::beam>(&c)) {
+        elements.assign(b->m_elements.begin(), b->m_elements.end());
+    } else if (auto *t = std::get_if<stan::tuplet>(&c)) {
+        elements.assign(t->m_elements.begin(), t->m_elements.end());
+    }
+
+    std::size_t j = i + 1;
+    for (const auto &e : elements) {
+        expect(j, mettle::less(i + n.m_size));
+        check_skeleton(s, j, e);
+        j += s.nodes()[j].m_size;
+    }
+    expect(j, equal_to(i + n.m_size));
+}
+
+mettle::suite<> skeleton_suite("lilypond skeleton", [](auto &_) {
+    static stan::lilypond::writer write;
+    static stan::lilypond::reader read;
+
+    property(_, "builds every column", [](std::vector<stan::column> music) {
+        std::string lily = "{";
+        for (const auto &c : music) {
+            lily += " " + write(c);
+        }
+        lily += " }";
+
+        stan::lilypond::skeleton s(lily);
+        expect(s.size(), equal_to(music.size()));
+        for (std::size_t i = 0; i < music.size(); ++i) {
+            check_skeleton(s, &s[i] - s.nodes().data(), music[i]);
+        }
+        expect(s.build(0, s.size(), read), equal_to(music));
+    });
+
+    _.test("ranges", []() {
+        std::string lily = R"({ \key d \minor c4 \clef bass <c e>4 \tuplet 3/2 {c8 [d16 e16] f8} })";
+        stan::lilypond::skeleton s(lily);
+        std::vector<std::string_view> text;
+        for (const auto &n : s.nodes()) {
+            text.push_back(s.text(n));
+        }
+        expect(text, equal_to(std::vector<std::string_view>{
+            R"(\key d \minor)", "c4", R"(\clef bass)", "<c e>4",
+            R"(\tuplet 3/2 {c8 [d16 e16] f8})", "c8", "[d16 e16]", "d16", "e16", "f8" }));
+        expect(s.size(), equal_to(5u));
+        expect(s[4].m_size, equal_to(6u));
+    });
+
+    _.test("unbalanced", []() {
+        for (std::string lily : { "c4", "{ [c4 }", "{ c4 ] }", "{ c4 >4 }" }) {
+            expect([&lily] { stan::lilypond::skeleton s(lily); },
+                   thrown<std::runtime_error>("parse error"));
+        }
+    });
+
+    _.test("no space between columns", []() {
+        expect([] { stan::lilypond::skeleton s("{ bf4f''32 }"); },
+               thrown<stan::exception>("no space before the column at byte 5"));
+        expect([] { stan::lilypond::skeleton s("{ <gf'' e>64r8 }"); },
+               thrown<stan::exception>("no space before the column at byte 12"));
+        expect([] { stan::lilypond::skeleton s("{ c4 d4[e8 f8] }"); },
+               thrown<stan::exception>("no space before the column at byte 7"));
+        expect(stan::lilypond::skeleton("{ [e8 f8]g4 }").size(), equal_to(2u));
+    });
+
+    _.test("errors when built", []() {
+        stan::lilypond::skeleton s("{ c4 crash d4 }");
+        expect(s.size(), equal_to(3u));
+        expect(s.build(s[0], read), equal_to(stan::column{ read("c4") }));
+        expect([&s] { s.build(s[1], read); }, thrown<std::runtime_error>("parse error"));
+    });
+});
+
+mettle::suite<> push_suite("lilypond push reader", [](auto &_) {
+    static stan::lilypond::writer write;
+
+    auto drain = [](std::string_view lily) {
+        std::vector<stan::column> result;
+        for (auto &c : stan::lilypond::sequence_reader(lily)) {
+            result.push_back(std::move(c));
+        }
+        return result;
+    };
+
+    auto push = [](std::string_view lily, const std::vector<std::size_t> &pieces) {
+        std::vector<stan::column> result;
+        stan::lilypond::push_reader read([&result](stan::column &&c) {
+            result.push_back(std::move(c));
+        });
+        std::size_t i = 0;
+        for (std::size_t piece : pieces) {
+            read.feed(lily.substr(std::min(i, lily.size()), piece));
+            i += piece;
+        }
+        read.feed(lily.substr(std::min(i, lily.size())));
+        read.finish();
+        return result;
+    };
+
+    property(_, "same as sequence_reader",
+             [drain, push](std::vector<stan::column> music, std::vector<std::uint8_t> pieces) {
+                 std::string lily = "{";
+                 for (const auto &c : music) {
+                     lily += " " + write(c);
+                 }
+                 lily += " }";
+
+                 std::vector<std::size_t> sizes(pieces.begin(), pieces.end());
+                 expect(push(lily, sizes), equal_to(drain(lily)));
+             });
+
+    _.test("one byte at a time", [drain, push]() {
+        std::string lily = R"({ \tuplet 3/2 {dss'''8 dss'''8 dss'''8} \key dss \minor c4})";
+        expect(push(lily, std::vector<std::size_t>(lily.size(), 1)), equal_to(drain(lily)));
+    });
+
+    _.test("no space between columns", [drain, push]() {
+        for (std::string lily : { "{ c4 d4[e8 f8] }", "{ bf4f''32 <gf'' e>64r8}" }) {
+            expect(push(lily, {}), equal_to(drain(lily)));
+            expect(push(lily, std::vector<std::size_t>(lily.size(), 1)), equal_to(drain(lily)));
+        }
+    });
+
+    _.test("handed over as soon as the next column begins", []() {
+        std::vector<stan::column> music;
+        stan::lilypond::push_reader read([&music](stan::column &&c) {
+            music.push_back(std::move(c));
+        });
+        read.feed("{ c4 [d8 e8] ");
+        expect(music.size(), equal_to(1u));
+        read.feed("\\tup");
+        expect(music.size(), equal_to(1u));
+        read.feed("let 3/2 {c8 d8 e8} }");
+        expect(music.size(), equal_to(2u));
+        read.finish();
+        expect(music.size(), equal_to(3u));
+    });
+
+    _.test("errors", [push]() {
+        expect([push] { push("{ c4 crash }", {}); }, thrown<std::runtime_error>("parse error"));
+        expect([push] { push("c4", {}); }, thrown<std::runtime_error>("parse error"));
+        expect([push] { push("{ c4", { 1, 1 }); }, thrown<std::runtime_error>("parse error"));
+        expect([push] { push("{ c4 } crash", { 3 }); },
+               thrown<std::runtime_error>("incomplete parse"));
+        expect([push] { push("{ c4 } }", { 3 }); },
+               thrown<std::runtime_error>("incomplete parse"));
+        expect([push] { push("{ c4 ] }", {}); }, thrown<std::runtime_error>("parse error"));
+        expect([push] { push("{ c4 ] }", { 1, 1, 1, 1, 1 }); },
+               thrown<std::runtime_error>("parse error"));
+        expect([push] { push("{ f'1 \\tplet 3/2 { c8 d8 e8 } }", {}); },
+               thrown<std::runtime_error>("parse error"));
+
+        // A stray closer fails the piece it is in, rather than leaving
+        // everything after it buffered until finish().
+        stan::lilypond::push_reader read([](stan::column &&) {});
+        read.feed("{ c4 ");
+        expect([&read] { read.feed("] d4 e4"); }, thrown<std::runtime_error>("parse error"));
+    });
+});
+
+mettle::suite<> events_suite("lilypond events", [](auto &_) {
+    static stan::lilypond::writer write;
+
+    // Records the kind of every event.
+    struct trace : stan::lilypond::event_handler
+    {
+        void on_rest(const stan::rest &) override { m_events += "r"; }
+        void on_note(const stan::note &) override { m_events += "n"; }
+        void on_chord(const stan::value &, stan::lilypond::pitch_span) override
+        {
+            m_events += "c";
+        }
+        void begin_beam() override { m_events += "["; }
+        void end_beam() override { m_events += "]"; }
+        void begin_tuplet(int num, int den) override
+        {
+            m_events += std::to_string(num) + "/" + std::to_string(den) + "{";
+        }
+        void end_tuplet() override { m_events += "}"; }
+        void on_meter(std::uint8_t, const stan::value &) override { m_events += "m"; }
+        void on_clef(const stan::clef &) override { m_events += "l"; }
+        void on_key(stan::pitchclass, stan::mode::id) override { m_events += "k"; }
+
+        std::string m_events;
+    };
+
+    property(_, "writes what the writer writes", [](std::vector<stan::column> music) {
+        std::string lily;
+        for (const auto &c : music) {
+            lily += (lily.empty() ? "" : "   ") + write(c);
+        }
+
+        std::string out;
+        stan::lilypond::event_writer writer(out);
+        stan::lilypond::event_reader()(lily, writer);
+
+        std::string expected;
+        for (const auto &c : music) {
+            expected += (expected.empty() ? "" : " ") + write(c);
+        }
+        expect(out, equal_to(expected));
+    });
+
+    _.test("order", []() {
+        trace t;
+        stan::lilypond::event_reader()(
+            R"(\key d \minor \clef bass \time 3/4 c4 r4 [<c e>8 \tuplet 3/2 {d16 e16 f16}])", t);
+        expect(t.m_events, equal_to("klmnr[c3/2{nnn}]"));
+    });
+
+    _.test("filter", []() {
+        struct strip_clefs : stan::lilypond::event_filter
+        {
+            using event_filter::event_filter;
+            void on_clef(const stan::clef &) override {}
+        };
+
+        std::string out;
+        stan::lilypond::event_writer writer(out);
+        strip_clefs filter(writer);
+        stan::lilypond::event_reader()(R"(\clef bass c4 [d8 \clef treble e8] <e c>2)", filter);
+        expect(out, equal_to("c4 [d8 e8] <c e>2"));
+    });
+
+    _.test("errors", []() {
+        trace t;
+        stan::lilypond::event_reader read;
+        expect([&] { read("c4 d4 crash", t); }, thrown<std::runtime_error>("parse error"));
+        expect(t.m_events, equal_to("nn"));
+        expect([&] { read("<c c>4", t); }, thrown<stan::invalid_chord>());
+
+        // The rules of the notation model, as reader checks them.
+        t.m_events.clear();
+        expect([&] { read("c4 [r4 c4]", t); }, thrown<stan::invalid_beam>());
+        expect(t.m_events, equal_to("n[rn"));
+        expect([&] { read("\\tuplet 3/2 { c4 c4 }", t); }, thrown<stan::invalid_tuplet>());
+        expect([&] { read("\\time 3/1", t); }, thrown<stan::invalid_meter>());
+        expect([&] { stan::lilypond::reader()("[r4 c4]"); }, thrown<stan::invalid_beam>());
+    });
+
+    _.test("reduced ratio", []() {
+        std::string out;
+        stan::lilypond::event_writer writer(out);
+        stan::lilypond::event_reader()("\\tuplet 6/4 {c8 d8 e8}", writer);
+        expect(out, equal_to("\\tuplet 3/2 {c8 d8 e8}"));
+    });
+});
+
+mettle::suite<> include_suite("lilypond include reader", [](auto &_) {
+    namespace fs = std::filesystem;
+
+    static stan::lilypond::writer write;
+    static stan::thread_pool pool(4);
+    static const fs::path directory = fs::temp_directory_path() / "test.include_reader";
+
+    auto put = [](const fs::path &name, const std::string &lily) {
+        fs::create_directories((directory / name).parent_path());
+        std::ofstream(directory / name) << lily;
+    };
+
+    auto text = [](const std::vector<stan::lilypond::include_reader::run> &runs) {
+        std::string lily;
+        for (const auto &r : runs) {
+            for (const auto &c : r) {
+                lily += (lily.empty() ? "" : " ") + write(c);
+            }
+        }
+        return lily;
+    };
+
+    _.setup([put]() {
+        fs::remove_all(directory);
+        put("score.ly", "{ \\include \"a.ly\" c4 \\include \"sub/b.ly\" }\n");
+        put("a.ly", "d4 e4\n");
+        put("sub/b.ly", "[f8 g8] \\include \"../a.ly\" r2\n");
+    });
+
+    _.teardown([]() { fs::remove_all(directory); });
+
+    _.test("includes", [text]() {
+        stan::lilypond::include_reader read(pool);
+        expect(text(read((directory / "score.ly").string())),
+               equal_to("d4 e4 c4 [f8 g8] d4 e4 r2"));
+        expect(read.parsed(), equal_to(3u));
+    });
+
+    _.test("only changed files are parsed", [put, text]() {
+        stan::lilypond::include_reader read(pool);
+        std::string score = (directory / "score.ly").string();
+        read(score);
+
+        read(score);
+        expect(read.parsed(), equal_to(0u));
+
+        put("a.ly", "d4 e4 f4\n");
+        expect(text(read(score)), equal_to("d4 e4 f4 c4 [f8 g8] d4 e4 f4 r2"));
+        expect(read.parsed(), equal_to(1u));
+
+        // A new time, but the same contents.
+        fs::last_write_time(directory / "a.ly",
+                            fs::last_write_time(directory / "a.ly") + std::chrono::seconds(5));
+        read(score);
+        expect(read.parsed(), equal_to(0u));
+    });
+
+    _.test("runs outlive a change", [put, text]() {
+        stan::lilypond::include_reader read(pool);
+        std::string score = (directory / "score.ly").string();
+        auto before = read(score);
+        put("a.ly", "d2\n");
+        auto after = read(score);
+        expect(text(before), equal_to("d4 e4 c4 [f8 g8] d4 e4 r2"));
+        expect(text(after), equal_to("d2 c4 [f8 g8] d2 r2"));
+    });
+
+    _.test("errors", [put]() {
+        stan::lilypond::include_reader read(pool);
+        std::string score = (directory / "score.ly").string();
+
+        put("a.ly", "d4 \\include \"sub/b.ly\"\n");
+        expect([&] { read(score); }, thrown<stan::exception>());
+
+        put("a.ly", "d4 \\include \"missing.ly\"\n");
+        expect([&] { read(score); }, thrown<stan::exception>());
+
+        put("a.ly", "d4 crash\n");
+        expect([&] { read(score); }, thrown<std::runtime_error>("parse error"));
+
+        put("a.ly", "d4\n");
+        read(score);
+        expect(read.parsed(), equal_to(1u));
+    });
+});
+
+mettle::suite<> variable_suite("lilypond variable reader", [](auto &_) {
+    static stan::lilypond::writer write;
+
+    auto text = [](const std::vector<stan::column> &music) {
+        std::string lily;
+        for (const auto &c : music) {
+            lily += " " + write(c);
+        }
+        return lily;
+    };
+
+    property(_, "same as the expanded sequence",
+             [text](std::vector<stan::column> theme, std::vector<stan::column> music) {
+                 std::string lily = "theme = {" + text(theme) + " }\n{ \\theme" + text(music) +
+                     " \\theme }";
+                 std::vector<stan::column> expanded = theme;
+                 expanded.insert(expanded.end(), music.begin(), music.end());
+                 expanded.insert(expanded.end(), theme.begin(), theme.end());
+
+                 stan::lilypond::variable_reader read;
+                 auto shared = read(lily);
+                 expect(shared->expand(), equal_to(expanded));
+                 expect(shared->m_size, equal_to(expanded.size()));
+             });
+
+    _.test("references share one parse", []() {
+        stan::lilypond::variable_reader read;
+        auto music = read(R"(
+            theme = { c4 [d8 e8] }
+            twice = { \theme r4 \theme }
+            { \twice \key c \major \theme })");
+
+        auto theme = read.variables().at("theme");
+        auto twice = read.variables().at("twice");
+        expect(theme->m_columns.size(), equal_to(2u));
+        expect(twice->m_columns.size(), equal_to(1u));
+        expect(twice->m_parts[0].m_music.get(), equal_to(theme.get()));
+        expect(twice->m_parts[2].m_music.get(), equal_to(theme.get()));
+        expect(music->m_parts[0].m_music.get(), equal_to(twice.get()));
+        expect(music->m_parts[2].m_music.get(), equal_to(theme.get()));
+        expect(music->m_size, equal_to(8u));
+
+        std::size_t columns = 0;
+        music->for_each([&columns](const stan::column &) { ++columns; });
+        expect(columns, equal_to(8u));
+    });
+
+    _.test("memory grows with unique material", []() {
+        std::string lily = "a = { c4 d4 }\n";
+        std::string previous = "a";
+        for (int i = 0; i < 40; ++i) {
+            std::string name = previous + "a";
+            lily += name + " = { \\" + previous + " \\" + previous + " }\n";
+            previous = name;
+        }
+        lily += "{ \\" + previous + " }";
+
+        stan::lilypond::variable_reader read;
+        expect(read(lily)->m_size, equal_to(std::size_t{ 2 } << 40));
+    });
+
+    _.test("assignment replaces", []() {
+        stan::lilypond::variable_reader read;
+        auto music = read("a = { c4 } b = { \\a } a = { d4 } { \\a \\b }");
+        expect(write(music->expand()[0]), equal_to("d4"));
+        expect(write(music->expand()[1]), equal_to("c4"));
+    });
+
+    property(_, "repeats unfold to copies of the body",
+             [text](std::vector<stan::column> body, std::uint8_t count) {
+                 std::uint32_t times = count % 8 + 1;
+                 std::string lily = "{ c4 \\repeat unfold " + std::to_string(times) + " {" +
+                     text(body) + " } }";
+                 std::vector<stan::column> expanded{ stan::lilypond::reader()("c4") };
+                 for (std::uint32_t i = 0; i < times; ++i) {
+                     expanded.insert(expanded.end(), body.begin(), body.end());
+                 }
+
+                 stan::lilypond::variable_reader read;
+                 auto shared = read(lily);
+                 expect(shared->m_columns.size(), equal_to(1u));
+                 expect(shared->m_size, equal_to(expanded.size()));
+                 expect(std::vector<stan::column>(shared->begin(), shared->end()),
+                        equal_to(expanded));
+
+                 stan::duration d = std::accumulate(expanded.begin(), expanded.end(),
+                                                    stan::duration::zero());
+                 expect(shared->m_duration, equal_to(d));
+             });
+
+    _.test("repeats", []() {
+        stan::lilypond::variable_reader read;
+        auto music = read(R"(
+            theme = { c4 }
+            { \repeat volta 2 { \theme d8 \repeat unfold 3 { e16 } } r4 })");
+        expect(music->m_parts.size(), equal_to(2u));
+        expect(music->m_parts[0].m_count, equal_to(2u));
+        expect(music->m_size, equal_to(11u));
+        std::vector<stan::column> expanded = music->expand();
+        expect(music->m_duration, equal_to(std::accumulate(expanded.begin(), expanded.end(),
+                                                           stan::duration::zero())));
+
+        std::string lily;
+        for (const auto &c : *music) {
+            lily += write(c) + " ";
+        }
+        expect(lily, equal_to("c4 d8 e16 e16 e16 c4 d8 e16 e16 e16 r4 "));
+
+        auto big = read(R"({ \repeat unfold 1000000000 { c4 d4 } })");
+        expect(big->m_size, equal_to(2000000000u));
+        stan::duration whole = stan::value::whole();
+        expect(big->m_duration, equal_to(500000000 * whole));
+        expect(write(*std::next(big->begin(), 5)), equal_to("d4"));
+    });
+
+    _.test("errors", []() {
+        stan::lilypond::variable_reader read;
+        expect([&] { read("{ \\theme }"); }, thrown<stan::exception>("\\theme is not defined"));
+        expect([&] { read("time = { c4 } { c4 }"); }, thrown<std::runtime_error>("parse error"));
+        expect([&] { read("theme = { c4 }"); }, thrown<std::runtime_error>("parse error"));
+        expect([&] { read("theme = c4 { c4 }"); }, thrown<std::runtime_error>("parse error"));
+        expect([&] { read("{ c4 "); }, thrown<std::runtime_error>("parse error"));
+        expect([&] { read("{ c4 crash }"); }, thrown<std::runtime_error>("parse error"));
+        expect([&] { read("{ c4 } d4"); }, thrown<std::runtime_error>("incomplete parse"));
+        expect([&] { read("{ \\repeat unfold 0 { c4 } }"); },
+               thrown<std::runtime_error>("parse error"));
+        expect([&] { read("{ \\repeat twice 2 { c4 } }"); },
+               thrown<std::runtime_error>("parse error"));
+        expect([&] { read("{ \\repeat unfold 2 c4 }"); },
+               thrown<std::runtime_error>("parse error"));
+        expect([&] { read("{ \\repeat unfold 2 { c4 ] }"); },
+               thrown<std::runtime_error>("parse error"));
+    });
+
+    _.test("nesting", []() {
+        auto nested = [](std::size_t depth) {
+            std::string lily = "{ ";
+            for (std::size_t i = 0; i < depth; ++i) {
+                lily += "\\repeat unfold 1 { c4 ";
+            }
+            return lily + std::string(depth, '}') + " }";
+        };
+
+        stan::lilypond::variable_reader read;
+        expect(read(nested(1000))->m_size, equal_to(1000u));
+        expect([&] { read(nested(1001)); },
+               thrown<stan::exception>("repeats nest deeper than 1000 levels"));
+    });
+});
+
+mettle::suite<> simultaneous_suite("lilypond simultaneous reader", [](auto &_) {
+    static stan::lilypond::writer write;
+    static stan::thread_pool pool(4);
+
+    property(_, "same as reading each voice",
+             [](std::vector<std::vector<stan::column>> voices) {
+                 std::string lily = "<<";
+                 for (const auto &v : voices) {
+                     lily += " {";
+                     for (const auto &c : v) {
+                         lily += " " + write(c);
+                     }
+                     lily += " }";
+                 }
+                 lily += " >>";
+
+                 stan::lilypond::simultaneous_reader read(pool);
+                 expect(read(lily).m_voices, equal_to(voices));
+             });
+
+    _.test("voices keep their order", []() {
+        stan::lilypond::simultaneous_reader read(pool);
+        auto music = read("<<\n{ c4 <c e>4 }\n{ d2 }\n{ }\n{ [e8 f8] }\n>>\n");
+        expect(music.m_voices.size(), equal_to(4u));
+        expect(write(music.m_voices[0][1]), equal_to("<c e>4"));
+        expect(write(music.m_voices[1][0]), equal_to("d2"));
+        expect(music.m_voices[2].size(), equal_to(0u));
+        expect(write(music.m_voices[3][0]), equal_to("[e8 f8]"));
+    });
+
+    _.test("errors", []() {
+        stan::lilypond::simultaneous_reader read(pool);
+        expect([&] { read("<< { <c c>4 } { c4 crash } >>"); }, thrown<stan::invalid_chord>());
+        expect([&] { read("<< { c4 crash } { <c c>4 } >>"); },
+               thrown<std::runtime_error>("parse error"));
+        expect([&] { read("{ c4 }"); }, thrown<std::runtime_error>("parse error"));
+        expect([&] { read("<< { c4 } "); }, thrown<std::runtime_error>("parse error"));
+        expect([&] { read("<< c4 >>"); }, thrown<std::runtime_error>("parse error"));
+        expect([&] { read("<< { c4 ] >>"); }, thrown<std::runtime_error>("parse error"));
+        expect([&] { read("<< { c4 } >> d4"); }, thrown<std::runtime_error>("incomplete parse"));
+    });
+});
+
+mettle::suite<> measure_suite("lilypond measure index", [](auto &_) {
+    namespace fs = std::filesystem;
+
+    static stan::lilypond::writer write;
+    static const std::string path = (fs::temp_directory_path() / "test.measure_index.ly").string();
+    static const std::string lily =
+        "{ c4 d4 e4 f4 \\time 3/4 g2. \\clef bass a2 b4 c1 \\key d \\minor [d8 e8] f4 r2 }\n";
+
+    auto text = [](const std::vector<stan::column> &music) {
+        std::string s;
+        for (const auto &c : music) {
+            s += (s.empty() ? "" : " ") + write(c);
+        }
+        return s;
+    };
+
+    _.setup([]() { std::ofstream(path) << lily; });
+
+    _.teardown([]() {
+        fs::remove(path);
+        fs::remove(path + ".idx");
+    });
+
+    _.test("measures", [text]() {
+        auto index = stan::lilypond::measure_index::build(path);
+        stan::lilypond::reader read;
+        expect(index.size(), equal_to(6u));
+        expect(text(index.measures(lily, 0, 1, read)), equal_to("c4 d4 e4 f4"));
+        expect(text(index.measures(lily, 1, 2, read)), equal_to("\\time 3/4 g2."));
+        expect(text(index.measures(lily, 3, 4, read)), equal_to("c1"));
+        expect(text(index.measures(lily, 4, 6, read)),
+               equal_to("\\key d \\minor [d8 e8] f4 r2"));
+        expect(text(index.measures(lily, 0, 6, read)),
+               equal_to(lily.substr(2, lily.size() - 5)));
+    });
+
+    _.test("in effect", []() {
+        auto index = stan::lilypond::measure_index::build(path);
+        expect(write(index.meter(1)), equal_to("\\time 4/4"));
+        expect(write(index.meter(2)), equal_to("\\time 3/4"));
+        expect(write(index.clef(2)), equal_to("\\clef treble"));
+        expect(write(index.clef(3)), equal_to("\\clef bass"));
+        expect(write(index.key(4)), equal_to("\\key c \\major"));
+        expect(write(index.key(5)), equal_to("\\key d \\minor"));
+    });
+
+    _.test("sidecar", [text]() {
+        auto built = stan::lilypond::measure_index::open(path);
+        expect(fs::exists(path + ".idx"), equal_to(true));
+
+        auto loaded = stan::lilypond::measure_index::load(path + ".idx");
+        expect(loaded.size(), equal_to(built.size()));
+        for (std::size_t i = 0; i < built.size(); ++i) {
+            expect(loaded[i].m_offset, equal_to(built[i].m_offset));
+        }
+        expect(loaded.current(path), equal_to(true));
+
+        // The same text, written again, is still current.
+        std::ofstream(path) << lily;
+        expect(loaded.current(path), equal_to(true));
+
+        std::string edited = lily;
+        edited[2] = 'e';
+        std::ofstream(path) << edited;
+        expect(loaded.current(path), equal_to(false));
+
+        stan::lilypond::reader read;
+        auto reopened = stan::lilypond::measure_index::open(path);
+        expect(text(reopened.measures(edited, 0, 1, read)), equal_to("e4 d4 e4 f4"));
+    });
+
+    _.test("no space between columns", [text]() {
+        std::string tight = "{ c2. d4[e8 f8] g2. r4 }\n";
+        std::ofstream(path) << tight;
+        auto index = stan::lilypond::measure_index::build(path);
+        stan::lilypond::reader read;
+        expect(index.size(), equal_to(3u));
+        expect(index[1].m_offset, equal_to(8u));
+        expect(text(index.measures(tight, 0, 1, read)), equal_to("c2. d4"));
+        expect(text(index.measures(tight, 1, 2, read)), equal_to("[e8 f8] g2."));
+        expect(text(index.measures(tight, 2, 3, read)), equal_to("r4"));
+    });
+
+    _.test("errors", []() {
+        auto index = stan::lilypond::measure_index::build(path);
+        stan::lilypond::reader read;
+        expect([&] { index.measures(lily + " ", 0, 1, read); }, thrown<stan::exception>());
+        expect([&] { index.measures(lily, 2, 7, read); }, thrown<stan::exception>());
+
+        std::ofstream(path + ".idx") << "stan.idx";
+        expect([] { stan::lilypond::measure_index::load(path + ".idx"); },
+               thrown<stan::exception>());
+
+        // A damaged sidecar is not trusted, and open() builds it again.
+        index.save(path + ".idx");
+        std::string sidecar;
+        {
+            std::ifstream in(path + ".idx", std::ios::binary);
+            sidecar.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        sidecar[56 + 10] = 100;
+        std::ofstream(path + ".idx", std::ios::binary) << sidecar;
+        expect([] { stan::lilypond::measure_index::load(path + ".idx"); },
+               thrown<stan::exception>());
+        expect(stan::lilypond::measure_index::open(path).size(), equal_to(index.size()));
+        expect(stan::lilypond::measure_index::load(path + ".idx").clef(0).m_type,
+               equal_to(stan::clef::type::treble));
+
+        std::ofstream(path) << "{ c4 crash }";
+        expect([] { stan::lilypond::measure_index::build(path); },
+               thrown<std::runtime_error>("parse error"));
+    });
+});
+
+using namespace stan::lilypond::literals;
+
+// Literals are parsed by the compiler, so these are checked by compiling.
+static_assert("4.."_ly == dot(dot(stan::value::quarter())));
+static_assert("cs''"_ly.m_pitchclass == stan::pitchclass::cs);
+static_assert("r16"_ly.m_value == stan::value::sixteenth());
+static_assert("\\key d \\minor"_ly.contains(stan::pitchclass::bf));
+static_assert("c'4 d'4 r2"_ly.m_columns.size() == 3);
+
+mettle::suite<
+    stan::rest,
+    stan::note,
+    stan::clef,
+    stan::key
+    >
+    literal_suite(
+        "lilypond literals", mettle::type_only, [](auto &_) {
+            using Event = mettle::fixture_type_t<decltype(_)>;
+
+            // The parser behind the literals runs at compile time, but it is
+            // the same code at run time, so it can be checked against the
+            // reader with any column.
+            property(_, "writeread", [](Event n) {
+                static stan::lilypond::writer write;
+                std::string lily = write(n);
+                auto c = stan::lilypond::literal_parser(lily)
+                             .whole<stan::lilypond::literal_parser::element>();
+                expect(c == stan::lilypond::literal_parser::element{ n }, equal_to(true));
+            });
         });
+
+mettle::suite<> phrase_suite("lilypond literal phrases", [](auto &_) {
+    _.test("columns", []() {
+        static constexpr auto music = "c'4 d'8. r2 \\clef bass \\key g \\major ef,,16.."_ly;
+        std::vector<stan::column> expected;
+        stan::lilypond::reader().append("c'4 d'8. r2 \\clef bass \\key g \\major ef,,16..",
+                                        expected);
+        expect(music.columns(), equal_to(expected));
+    });
+
+    _.test("errors", []() {
+        using stan::lilypond::literal_parser;
+        expect([] { literal_parser::count("c'4 h4"); }, thrown<std::runtime_error>("parse error"));
+        expect([] { literal_parser::count("<c e>4"); }, thrown<std::runtime_error>());
+        expect([] { literal_parser("c4 d4").whole<literal_parser::element>(); },
+               thrown<std::runtime_error>("incomplete parse"));
+    });
+});
+
+// Inputs the fuzzer found, each of which once crashed the reader or took
+// it too long.  Both backends must agree on each, as the fuzz target checks,
+// within a time that grows no faster than the input.
+mettle::suite<> fuzz_suite("lilypond fuzz corpus", [](auto &_) {
+    namespace fs = std::filesystem;
+
+    _.test("time bound", []() {
+        stan::lilypond::reader read;
+        stan::lilypond::predictive_reader predict;
+        stan::lilypond::writer write;
+
+        auto outcome = [&write](auto &reader, std::string_view lily) {
+            try {
+                return write(reader(lily));
+            } catch (const std::exception &e) {
+                return std::string(e.what());
+            }
+        };
+
+        std::vector<std::string> slow;
+        for (const auto &entry : fs::directory_iterator(STAN_FUZZ_CORPUS)) {
+            std::ifstream in(entry.path(), std::ios::binary);
+            std::string lily{ std::istreambuf_iterator<char>(in),
+                              std::istreambuf_iterator<char>() };
+
+            auto start = std::chrono::steady_clock::now();
+            expect(outcome(predict, lily), equal_to(outcome(read, lily)));
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+            // Very generous, so that it holds in a debug or coverage build.
+            if (elapsed.count() > 0.01 + 1e-6 * static_cast<double>(lily.size())) {
+                slow.push_back(entry.path().filename().string());
+            }
+        }
+        expect(slow, equal_to(std::vector<std::string>{}));
+    });
+
+    _.test("nesting", []() {
+        std::string lily = std::string(100000, '[') + "c8 d8" + std::string(100000, ']');
+        expect([&] { stan::lilypond::reader()(lily); }, thrown<stan::exception>());
+        expect([&] { stan::lilypond::predictive_reader()(lily); }, thrown<stan::exception>());
+        expect(stan::lilypond::reader().parse(lily).has_value(), equal_to(false));
+    });
+});
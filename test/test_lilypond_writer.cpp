@@ -1,9 +1,14 @@
 #include <stan/notation.hpp>
 #include <stan/driver/lilypond.hpp>
+#include <stan/thread_pool.hpp>
 
 #include <mettle.hpp>
 #include "property.hpp"
 
+#include <cstdio>
+#include <sstream>
+#include <unistd.h>
+
 using mettle::equal_to;
 using mettle::expect;
 using mettle::regex_match;
@@ -127,3 +132,85 @@ mettle::suite<> lilypond_suite("lilypond writer", [](auto &_) {
 	expect(write(clef{ clef::type::percussion }), equal_to(R"(\clef percussion)"));
     });
 });
+
+mettle::suite<> sequence_suite("lilypond sequence writer", [](auto &_) {
+    static stan::lilypond::writer write;
+
+    property(_, "writeread", [](std::vector<stan::column> music) {
+        std::ostringstream stream;
+        stan::lilypond::sequence_writer out(stream);
+        std::string expected = "{ ";
+        for (const auto &c : music) {
+            out(c);
+            expected += write(c) + " ";
+        }
+        out.finish();
+        expect(stream.str(), equal_to(expected + "}\n"));
+
+        std::istringstream in(stream.str());
+        std::vector<stan::column> result;
+        for (auto &c : stan::lilypond::sequence_reader(in)) {
+            result.push_back(std::move(c));
+        }
+        expect(result, equal_to(music));
+    });
+
+    // Enough to fill the buffers several times over, with text that is
+    // written without a copy in between.
+    _.test("file descriptor", []() {
+        using stan::lilypond::sequence_writer;
+        stan::column n = stan::note{ stan::value::eighth(),
+                                     { stan::pitchclass::cs, stan::octave(5) } };
+        std::string large;
+        while (large.size() < sequence_writer::buffer_size) {
+            large += "r4 ";
+        }
+
+        std::FILE *file = std::tmpfile();
+        std::ostringstream stream;
+        sequence_writer to_file(fileno(file));
+        sequence_writer to_stream(stream);
+        for (int i = 0; i < 200000; ++i) {
+            to_file(n);
+            to_stream(n);
+            if (i % 10000 == 0) {
+                to_file.append(large);
+                to_stream.append(large);
+            }
+        }
+        to_file.finish();
+        to_stream.finish();
+
+        std::string lily(stream.str().size(), '\0');
+        expect(::pread(fileno(file), lily.data(), lily.size(), 0),
+               equal_to(static_cast<ssize_t>(lily.size())));
+        std::fclose(file);
+        expect(lily, equal_to(stream.str()));
+    });
+});
+
+mettle::suite<> parallel_suite("lilypond parallel writer", [](auto &_) {
+    static stan::thread_pool pool(4);
+
+    // A range for every column, so that even short music is split.
+    property(_, "same as sequence_writer", [](std::vector<stan::column> music) {
+        std::ostringstream stream;
+        stan::lilypond::sequence_writer out(stream);
+        for (const auto &c : music) {
+            out(c);
+        }
+        out.finish();
+
+        stan::lilypond::parallel_writer write(pool, 1);
+        expect(write(music), equal_to(stream.str()));
+
+        std::FILE *file = std::tmpfile();
+        write(music, fileno(file));
+        std::string lily(stream.str().size(), '\0');
+        expect(::pread(fileno(file), lily.data(), lily.size(), 0),
+               equal_to(static_cast<ssize_t>(lily.size())));
+        expect(::lseek(fileno(file), 0, SEEK_CUR), equal_to(static_cast<off_t>(lily.size())));
+        std::fclose(file);
+        expect(lily, equal_to(stream.str()));
+    });
+});
@@ -94,6 +94,22 @@ mettle::suite<> tuplet_suite("tuplet", [](auto &_) {
         expect(tuplet::scale(7, 4, 7 * value::quarter()), equal_to(value::whole()));
     });
 
+    _.test("ratio", []() {
+        tuplet triplet{ quarter, c8, c8, c8 };
+        expect(triplet.num(), equal_to(3));
+        expect(triplet.den(), equal_to(2));
+
+        tuplet duplet{ dot(quarter), c8, c8 };
+        expect(duplet.num(), equal_to(2));
+        expect(duplet.den(), equal_to(3));
+
+        // Given, the ratio is kept in lowest terms.
+        tuplet sextuplet(6, 4, std::pmr::vector<column>(6, c8));
+        expect(sextuplet.m_value, equal_to(value::half()));
+        expect(sextuplet.num(), equal_to(3));
+        expect(sextuplet.den(), equal_to(2));
+    });
+
     property(_, "generate", [](tuplet v) {
         stan::duration d = v; // Invoke cast operator
         expect(d, mettle::greater(duration::zero()));
@@ -102,5 +118,15 @@ mettle::suite<> tuplet_suite("tuplet", [](auto &_) {
     _.test("invalid", []() {
         expect([] { tuplet::scale(3, 7, value::quarter()); },
                thrown<stan::invalid_tuplet>());
+        expect([] { tuplet::scale(0, 2, value::quarter()); },
+               thrown<stan::invalid_tuplet>("invalid tuplet: ratio 0/2 must be positive"));
+        expect([] { tuplet::scale(3, 0, value::quarter()); },
+               thrown<stan::invalid_tuplet>("invalid tuplet: ratio 3/0 must be positive"));
+        expect([] { tuplet::scale(-3, 2, value::quarter()); },
+               thrown<stan::invalid_tuplet>("invalid tuplet: ratio -3/2 must be positive"));
+
+        // The outer duration of this one overflows 32 bits.
+        expect([] { tuplet::scale(1 << 30, 2, value::quarter()); },
+               thrown<stan::invalid_tuplet>());
     });
 });